@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    Offline batch renderer: runs audio files through EqualizerAudioProcessor
+    with a state saved by getStateInformation(), without a plugin host.
+
+    Built as a console application next to the plugin, see README.md.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+static const char* usage =
+	"Usage: EqualizerBatchRenderer --state <file> --output <directory> [--threads <n>] [--block-size <n>] <input files...>\n"
+	"\n"
+	"  --state       state blob as written by getStateInformation()\n"
+	"  --output      directory for the processed files, which keep their names and formats,\n"
+	"                so no two inputs may have the same file name\n"
+	"  --threads     number of worker threads, one processor each (default: number of cores)\n"
+	"  --block-size  samples per processBlock call (default: 8192)\n";
+
+struct RenderSettings
+{
+	juce::MemoryBlock state;
+	juce::File outputDirectory;
+	int blockSize = 8192;
+};
+
+struct RenderResult
+{
+	juce::File input;
+	juce::String error;
+	double audioSeconds = 0.0;
+	double renderSeconds = 0.0;
+};
+
+//==============================================================================
+// Renders one file with an already configured processor. The processor's latency
+// is compensated, so the output is sample aligned with the input and just as long.
+static RenderResult renderFile(EqualizerAudioProcessor& processor,
+	juce::AudioFormatManager& formatManager,
+	const RenderSettings& settings,
+	const juce::File& input)
+{
+	RenderResult result;
+	result.input = input;
+
+	std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+	if (reader == nullptr)
+	{
+		result.error = "unsupported or unreadable file";
+		return result;
+	}
+
+	const auto numChannels = (int)reader->numChannels;
+	const auto sampleRate = reader->sampleRate;
+	const auto length = reader->lengthInSamples;
+
+	if (numChannels > EqualizerAudioProcessor::maxNumChannels)
+	{
+		result.error = "too many channels";
+		return result;
+	}
+
+	auto output = settings.outputDirectory.getChildFile(input.getFileName());
+
+	if (output == input)
+	{
+		result.error = "output would overwrite the input";
+		return result;
+	}
+
+	auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+	output.deleteFile();
+	auto stream = std::make_unique<juce::FileOutputStream>(output);
+
+	std::unique_ptr<juce::AudioFormatWriter> writer;
+
+	if (format != nullptr && stream->openedOk())
+		writer.reset(format->createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels,
+			(int)reader->bitsPerSample, reader->metadataValues, 0));
+
+	if (writer == nullptr)
+	{
+		result.error = "couldn't create " + output.getFullPathName();
+		return result;
+	}
+
+	stream.release(); // the writer owns it now
+
+	auto startTicks = juce::Time::getHighResolutionTicks();
+
+	processor.setNonRealtime(true);
+	processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.blockSize);
+	processor.prepareToPlay(sampleRate, settings.blockSize);
+
+	// Feed 'latency' samples of silence past the end and drop as many from the start
+	const auto latency = (juce::int64)processor.getLatencySamples();
+
+	juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+	juce::MidiBuffer midi;
+
+	for (juce::int64 position = 0; position < length + latency; position += settings.blockSize)
+	{
+		const auto numSamples = (int)juce::jmin((juce::int64)settings.blockSize, length + latency - position);
+
+		buffer.setSize(numChannels, numSamples, false, false, true);
+		reader->read(&buffer, 0, numSamples, position, true, true);
+
+		processor.processBlock(buffer, midi);
+
+		const auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples, latency - position);
+
+		if (skip < numSamples && !writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip))
+		{
+			result.error = "couldn't write " + output.getFullPathName();
+			break;
+		}
+	}
+
+	processor.releaseResources();
+	writer.reset();
+
+	result.renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+	result.audioSeconds = (double)length / sampleRate;
+
+	return result;
+}
+
+//==============================================================================
+// Worker thread owning one processor, taking files off the shared queue until it's empty
+struct RenderWorker : juce::Thread
+{
+	RenderWorker(const RenderSettings& renderSettings,
+		const juce::Array<juce::File>& inputFiles,
+		std::atomic<int>& nextFileIndex,
+		std::vector<RenderResult>& renderResults) :
+		juce::Thread("Render Worker"),
+		settings(renderSettings),
+		files(inputFiles),
+		nextFile(nextFileIndex),
+		results(renderResults)
+	{
+		formatManager.registerBasicFormats();
+		processor.setStateInformation(settings.state.getData(), (int)settings.state.getSize());
+	}
+
+	void run() override
+	{
+		for (auto index = nextFile.fetch_add(1); index < files.size() && !threadShouldExit(); index = nextFile.fetch_add(1))
+			results[(size_t)index] = renderFile(processor, formatManager, settings, files.getReference(index));
+	}
+
+private:
+	const RenderSettings& settings;
+	const juce::Array<juce::File>& files;
+	std::atomic<int>& nextFile;
+
+	// Every index is written by exactly one worker
+	std::vector<RenderResult>& results;
+
+	EqualizerAudioProcessor processor;
+	juce::AudioFormatManager formatManager;
+};
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	juce::ArgumentList arguments(argc, argv);
+
+	if (arguments.containsOption("--help|-h") || !arguments.containsOption("--state") || !arguments.containsOption("--output"))
+	{
+		std::cout << usage;
+		return arguments.containsOption("--help|-h") ? 0 : 1;
+	}
+
+	RenderSettings settings;
+
+	auto stateFile = arguments.getFileForOptionAndRemove("--state");
+	auto numThreads = juce::SystemStats::getNumCpus();
+
+	if (!stateFile.loadFileAsData(settings.state) || settings.state.isEmpty())
+	{
+		std::cerr << "Couldn't read the state from " << stateFile.getFullPathName() << std::endl;
+		return 1;
+	}
+
+	settings.outputDirectory = arguments.getFileForOptionAndRemove("--output");
+
+	if (!settings.outputDirectory.createDirectory())
+	{
+		std::cerr << "Couldn't create " << settings.outputDirectory.getFullPathName() << std::endl;
+		return 1;
+	}
+
+	if (arguments.containsOption("--threads"))
+		numThreads = juce::jmax(1, arguments.removeValueForOption("--threads").getIntValue());
+
+	if (arguments.containsOption("--block-size"))
+		settings.blockSize = juce::jlimit(32, 1 << 20, arguments.removeValueForOption("--block-size").getIntValue());
+
+	juce::Array<juce::File> files;
+
+	for (auto& argument : arguments.arguments)
+		files.add(argument.resolveAsFile());
+
+	if (files.isEmpty())
+	{
+		std::cout << usage;
+		return 1;
+	}
+
+	// Every output keeps its input's name, so two inputs with the same name would be written
+	// to the same file by two workers at once. Compared without case, like most file systems do.
+	juce::StringArray outputNames;
+	bool hasDuplicateNames = false;
+
+	for (const auto& file : files)
+	{
+		if (auto previous = outputNames.indexOf(file.getFileName(), true); previous >= 0)
+		{
+			std::cerr << file.getFullPathName() << " and " << files.getReference(previous).getFullPathName()
+				<< " would both be written to " << settings.outputDirectory.getChildFile(file.getFileName()).getFullPathName() << std::endl;
+			hasDuplicateNames = true;
+		}
+
+		outputNames.add(file.getFileName());
+	}
+
+	if (hasDuplicateNames)
+		return 1;
+
+	// Processors are created here on the message thread, then each one only ever runs on its worker
+	std::vector<RenderResult> results((size_t)files.size());
+	std::atomic<int> nextFile{ 0 };
+
+	juce::OwnedArray<RenderWorker> workers;
+
+	for (int i = 0; i < juce::jmin(numThreads, files.size()); ++i)
+		workers.add(new RenderWorker(settings, files, nextFile, results));
+
+	auto startTicks = juce::Time::getHighResolutionTicks();
+
+	for (auto* worker : workers)
+		worker->startThread();
+
+	for (auto* worker : workers)
+		worker->waitForThreadToExit(-1);
+
+	auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+	// Realtime factor: seconds of audio rendered per second of processing
+	double totalAudioSeconds = 0.0;
+	int numFailed = 0;
+
+	std::cout << "file, audio seconds, render seconds, realtime factor" << std::endl;
+
+	for (const auto& result : results)
+	{
+		if (result.error.isNotEmpty())
+		{
+			std::cerr << result.input.getFullPathName() << ": " << result.error << std::endl;
+			++numFailed;
+			continue;
+		}
+
+		totalAudioSeconds += result.audioSeconds;
+
+		std::cout << result.input.getFileName() << ", " << result.audioSeconds << ", " << result.renderSeconds << ", "
+			<< result.audioSeconds / juce::jmax(result.renderSeconds, 1.0e-9) << std::endl;
+	}
+
+	std::cout << "total (" << workers.size() << " threads), " << totalAudioSeconds << ", " << wallSeconds << ", "
+		<< totalAudioSeconds / juce::jmax(wallSeconds, 1.0e-9) << std::endl;
+
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,1094 @@
+/*
+  ==============================================================================
+
+    Benchmarks for the Equalizer DSP and analyzer code.
+
+    Built as a console application next to the plugin, see README.md.
+    Results are written as JSON, so runs can be compared against each other.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "../Source/PluginEditor.h"
+
+//==============================================================================
+// Allocation counting for the realtime checks. Only a thread that armed the counter is
+// counted, so the designer thread doesn't show up. juce::String, std::vector,
+// std::function and the juce::dsp designs all allocate through these.
+static thread_local bool isCountingAllocations = false;
+static std::atomic<int> numCountedAllocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+	if (isCountingAllocations)
+		numCountedAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	if (auto* memory = std::malloc(size == 0 ? 1 : size))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+// Freeing memory on the audio thread is just as bad, so it's counted too
+void operator delete(void* memory) noexcept
+{
+	if (isCountingAllocations && memory != nullptr)
+		numCountedAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept { operator delete(memory); }
+void operator delete(void* memory, std::size_t) noexcept { operator delete(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { operator delete(memory); }
+
+// Counts every operator new and delete on the current thread while it's in scope
+struct ScopedAllocationCounter
+{
+	ScopedAllocationCounter()
+	{
+		numCountedAllocations.store(0);
+		isCountingAllocations = true;
+	}
+
+	~ScopedAllocationCounter() { isCountingAllocations = false; }
+
+	int getNumAllocations() const { return numCountedAllocations.load(); }
+};
+
+//==============================================================================
+// Collects one JSON object per measurement
+struct BenchmarkReport
+{
+	using Properties = std::initializer_list<std::pair<const char*, juce::var>>;
+
+	void add(const juce::String& benchmark, Properties properties)
+	{
+		auto* result = new juce::DynamicObject();
+		result->setProperty("benchmark", benchmark);
+
+		for (const auto& property : properties)
+			result->setProperty(property.first, property.second);
+
+		results.add(juce::var(result));
+	}
+
+	juce::String toJSON() const
+	{
+		auto* root = new juce::DynamicObject();
+
+		root->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+		root->setProperty("cpu", juce::SystemStats::getCpuModel());
+		root->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+		root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+		root->setProperty("biquad_kernel", EQUALIZER_BIQUAD_KERNEL);
+		root->setProperty("results", results);
+
+		return juce::JSON::toString(juce::var(root));
+	}
+
+private:
+	juce::Array<juce::var> results;
+};
+
+// Keeps the optimiser from dropping work whose result isn't otherwise used
+static volatile double benchmarkSink = 0.0;
+
+// Best of a few runs, which is the least disturbed by other processes
+template<typename Function>
+static double measureSeconds(Function&& function, int repetitions = 5)
+{
+	auto best = std::numeric_limits<double>::max();
+
+	for (int i = 0; i < repetitions; ++i)
+	{
+		auto start = juce::Time::getHighResolutionTicks();
+		function();
+		best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+	}
+
+	return best;
+}
+
+static juce::String getSlopeName(int slope)
+{
+	return juce::String(12 + slope * 12) + " db/Oct";
+}
+
+//==============================================================================
+// Compares the biquad kernels from BiquadKernels.h on the worst case they were
+// written for: a 48 dB/Oct LowCut at 20 Hz. Reports the cost per channel sample and
+// the error against a long double reference, relative to the reference's level.
+struct KernelResult
+{
+	double nanosecondsPerSample = 0.0;
+	double noiseFloorDecibels = 0.0;
+};
+
+static std::array<BiquadCoefficients, 4> makeLowCutStages(double sampleRate)
+{
+	std::array<BiquadCoefficients, 4> stages;
+
+	for (int i = 0; i < (int)stages.size(); ++i)
+		stages[(size_t)i] = makeHighPassBiquad(sampleRate, 20.0, getButterworthQuality(i, (int)stages.size()));
+
+	return stages;
+}
+
+static std::vector<float> makeTestSignal(int numSamples)
+{
+	juce::Random random(0x5eed);
+	std::vector<float> signal((size_t)numSamples);
+
+	for (auto& sample : signal)
+		sample = random.nextFloat() - 0.5f;
+
+	return signal;
+}
+
+static std::vector<long double> processReference(const std::vector<float>& input, const std::array<BiquadCoefficients, 4>& stages)
+{
+	std::vector<long double> output(input.begin(), input.end());
+
+	for (const auto& c : stages)
+	{
+		long double s1 = 0, s2 = 0;
+
+		for (auto& sample : output)
+		{
+			auto x = sample;
+			auto y = c.b0 * x + s1;
+			s1 = c.b1 * x - c.a1 * y + s2;
+			s2 = c.b2 * x - c.a2 * y;
+			sample = y;
+		}
+	}
+
+	return output;
+}
+
+template<template<typename> class Kernel, typename SampleType>
+static KernelResult benchmarkKernel(double sampleRate, const std::vector<float>& input)
+{
+	constexpr size_t blockSize = 512;
+	constexpr auto numLanes = sizeof(SampleType) / sizeof(float);
+	const auto numBlocks = input.size() / blockSize;
+
+	const auto stages = makeLowCutStages(sampleRate);
+	std::array<Kernel<SampleType>, 4> kernels;
+
+	for (size_t i = 0; i < kernels.size(); ++i)
+	{
+		kernels[i].prepare({ sampleRate, (juce::uint32)blockSize, 1 });
+		kernels[i].setCoefficients(stages[i]);
+	}
+
+	juce::HeapBlock<char> blockData;
+	juce::dsp::AudioBlock<SampleType> block(blockData, 1, blockSize);
+	auto* lanes = reinterpret_cast<float*>(block.getChannelPointer(0));
+
+	std::vector<float> output(input.size());
+	juce::int64 ticks = 0;
+
+	for (size_t blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+	{
+		const auto* source = input.data() + blockIndex * blockSize;
+
+		// Every lane gets the same signal
+		for (size_t i = 0; i < blockSize; ++i)
+			for (size_t lane = 0; lane < numLanes; ++lane)
+				lanes[i * numLanes + lane] = source[i];
+
+		juce::dsp::ProcessContextReplacing<SampleType> context(block);
+
+		auto start = juce::Time::getHighResolutionTicks();
+
+		for (auto& kernel : kernels)
+			kernel.process(context);
+
+		ticks += juce::Time::getHighResolutionTicks() - start;
+
+		for (size_t i = 0; i < blockSize; ++i)
+			output[blockIndex * blockSize + i] = lanes[i * numLanes];
+	}
+
+	const auto reference = processReference(input, stages);
+	long double errorPower = 0, referencePower = 0;
+
+	for (size_t i = 0; i < numBlocks * blockSize; ++i)
+	{
+		auto error = (long double)output[i] - reference[i];
+		errorPower += error * error;
+		referencePower += reference[i] * reference[i];
+	}
+
+	KernelResult result;
+	result.nanosecondsPerSample = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / double(numBlocks * blockSize * numLanes);
+	result.noiseFloorDecibels = 10.0 * std::log10((double)(errorPower / juce::jmax(referencePower, (long double)1.0e-30)));
+
+	return result;
+}
+
+static void runKernelBenchmarks(BenchmarkReport& report)
+{
+	for (auto sampleRate : { 44100.0, 96000.0, 192000.0 })
+	{
+		// Ten seconds of audio, so the 20 Hz poles have time to ring
+		const auto input = makeTestSignal(int(sampleRate * 10.0));
+
+		auto add = [&report, sampleRate](const char* kernel, const char* sampleType, KernelResult result)
+			{
+				report.add("biquad_kernel", { { "kernel", kernel },
+					{ "sample_type", sampleType },
+					{ "sample_rate", sampleRate },
+					{ "ns_per_sample", result.nanosecondsPerSample },
+					{ "noise_floor_db", result.noiseFloorDecibels } });
+			};
+
+		add("TDF2Biquad", "float", benchmarkKernel<TDF2Biquad, float>(sampleRate, input));
+		add("DoubleTDF2Biquad", "float", benchmarkKernel<DoubleTDF2Biquad, float>(sampleRate, input));
+		add("SVFBiquad", "float", benchmarkKernel<SVFBiquad, float>(sampleRate, input));
+
+		add("TDF2Biquad", "SIMDRegister<float>", benchmarkKernel<TDF2Biquad, SIMDSample>(sampleRate, input));
+		add("DoubleTDF2Biquad", "SIMDRegister<float>", benchmarkKernel<DoubleTDF2Biquad, SIMDSample>(sampleRate, input));
+		add("SVFBiquad", "SIMDRegister<float>", benchmarkKernel<SVFBiquad, SIMDSample>(sampleRate, input));
+	}
+}
+
+//==============================================================================
+// processBlock on a stereo buffer of noise. Every configuration processes the same
+// amount of audio, so small blocks show the per-call overhead.
+static void setParameter(EqualizerAudioProcessor& processor, const juce::String& parameterID, float value)
+{
+	auto* parameter = processor.apvts.getParameter(parameterID);
+	parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+static double benchmarkProcessBlock(EqualizerAudioProcessor& processor, double sampleRate, int blockSize)
+{
+	constexpr int numChannels = 2;
+	constexpr int samplesPerRun = 1 << 16;
+
+	// Designs the coefficients synchronously for the current parameters
+	processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+	processor.prepareToPlay(sampleRate, blockSize);
+
+	juce::AudioBuffer<float> buffer(numChannels, blockSize);
+	juce::MidiBuffer midi;
+	juce::Random random(0x5eed);
+
+	for (int channel = 0; channel < numChannels; ++channel)
+		for (int i = 0; i < blockSize; ++i)
+			buffer.setSample(channel, i, random.nextFloat() - 0.5f);
+
+	// Warm up caches and let the smoothers settle
+	processor.processBlock(buffer, midi);
+
+	const auto seconds = measureSeconds([&]
+		{
+			for (int processed = 0; processed < samplesPerRun; processed += blockSize)
+				processor.processBlock(buffer, midi);
+		}, 3);
+
+	benchmarkSink = benchmarkSink + buffer.getSample(0, 0);
+	processor.releaseResources();
+
+	const auto numSamples = ((samplesPerRun + blockSize - 1) / blockSize) * blockSize;
+	return seconds * 1.0e9 / double(numSamples * numChannels);
+}
+
+static void runProcessBlockBenchmarks(BenchmarkReport& report)
+{
+	EqualizerAudioProcessor processor;
+
+	// Keep every band active, in both parameter sets
+	for (const juce::String prefix : { juce::String(), sideParameterPrefix })
+	{
+		setParameter(processor, prefix + "LowCut Freq", 40.f);
+		setParameter(processor, prefix + "HighCut Freq", 15000.f);
+		setParameter(processor, prefix + getBandParameterID(0, "Gain"), 6.f);
+	}
+
+	for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+	{
+		for (int blockSize = 16; blockSize <= 4096; blockSize *= 2)
+		{
+			auto add = [&report, sampleRate, blockSize](const char* mode, int lowCutSlope, int highCutSlope, double nanosecondsPerSample)
+				{
+					report.add("processBlock", { { "mode", mode },
+						{ "sample_rate", sampleRate },
+						{ "block_size", blockSize },
+						{ "low_cut_slope", getSlopeName(lowCutSlope) },
+						{ "high_cut_slope", getSlopeName(highCutSlope) },
+						{ "ns_per_sample", nanosecondsPerSample },
+						{ "realtime_load", nanosecondsPerSample * 2.0 * sampleRate * 1.0e-9 } });
+				};
+
+			setParameter(processor, "Linear Phase", 0.f);
+
+			for (int lowCutSlope = 0; lowCutSlope < NumSlopes; ++lowCutSlope)
+			{
+				for (int highCutSlope = 0; highCutSlope < NumSlopes; ++highCutSlope)
+				{
+					setParameter(processor, "LowCut Slope", (float)lowCutSlope);
+					setParameter(processor, "HighCut Slope", (float)highCutSlope);
+
+					add("iir", lowCutSlope, highCutSlope, benchmarkProcessBlock(processor, sampleRate, blockSize));
+				}
+			}
+
+			// The kernel length doesn't depend on the slopes, so one combination is enough
+			setParameter(processor, "Linear Phase", 1.f);
+			add("linear_phase", NumSlopes - 1, NumSlopes - 1, benchmarkProcessBlock(processor, sampleRate, blockSize));
+
+			// The other processing modes, with the slopes still at their steepest
+			static constexpr std::array<const char*, NumProcessingModes> processingModeNames{ "iir", "iir_left", "iir_right", "iir_mid", "iir_side", "iir_mid_side" };
+
+			setParameter(processor, "Linear Phase", 0.f);
+
+			for (int processingMode = LeftOnly; processingMode < NumProcessingModes; ++processingMode)
+			{
+				setParameter(processor, "Processing Mode", (float)processingMode);
+				add(processingModeNames[(size_t)processingMode], NumSlopes - 1, NumSlopes - 1, benchmarkProcessBlock(processor, sampleRate, blockSize));
+			}
+
+			setParameter(processor, "Processing Mode", (float)Stereo);
+
+			// The cost should grow with the number of parametric bands switched on, not with the maximum
+			for (auto numBands : { 1, 4, 8, 16, maxParametricBands })
+			{
+				for (int band = 0; band < maxParametricBands; ++band)
+					setParameter(processor, getBandParameterID(band, "Bypassed"), band < numBands ? 0.f : 1.f);
+
+				const auto nanosecondsPerSample = benchmarkProcessBlock(processor, sampleRate, blockSize);
+
+				report.add("processBlock_bands", { { "sample_rate", sampleRate },
+					{ "block_size", blockSize },
+					{ "num_bands", numBands },
+					{ "ns_per_sample", nanosecondsPerSample } });
+			}
+
+			for (int band = 1; band < maxParametricBands; ++band)
+				setParameter(processor, getBandParameterID(band, "Bypassed"), 1.f);
+		}
+
+		std::cerr << "processBlock: " << sampleRate << " Hz done" << std::endl;
+	}
+}
+
+//==============================================================================
+// The juce::dsp designs the plugin started out with against the closed-form ones the chain uses now
+static void runCoefficientDesignBenchmarks(BenchmarkReport& report)
+{
+	constexpr int numDesigns = 2000;
+	constexpr double sampleRate = 48000.0;
+
+	ChainSettings settings;
+	auto& bandSettings = settings.bands[0];
+	bandSettings.gainInDecibels = 6.f;
+
+	// Sweep the frequencies, like an automated parameter would
+	auto getFrequency = [](int i) { return 20.f * std::pow(1000.f, float(i % 100) / 100.f); };
+
+	auto add = [&report](const char* design, const juce::String& slope, double seconds)
+		{
+			report.add("coefficient_design", { { "design", design },
+				{ "slope", slope },
+				{ "ns_per_design", seconds * 1.0e9 / numDesigns } });
+		};
+
+	add("makePeakFilter", {}, measureSeconds([&]
+		{
+			for (int i = 0; i < numDesigns; ++i)
+			{
+				bandSettings.freq = getFrequency(i);
+				benchmarkSink = benchmarkSink + makePeakFilter(bandSettings, sampleRate)->coefficients[0];
+			}
+		}));
+
+	add("makePeakBiquad", {}, measureSeconds([&]
+		{
+			for (int i = 0; i < numDesigns; ++i)
+				benchmarkSink = benchmarkSink + makePeakBiquad(sampleRate, getFrequency(i), 1.0, 2.0).b0;
+		}));
+
+	for (int slope = 0; slope < NumSlopes; ++slope)
+	{
+		settings.lowCutSlope = settings.highCutSlope = (Slope)slope;
+
+		add("makeLowCutFilter", getSlopeName(slope), measureSeconds([&]
+			{
+				for (int i = 0; i < numDesigns; ++i)
+				{
+					settings.lowCutFreq = getFrequency(i);
+					benchmarkSink = benchmarkSink + makeLowCutFilter(settings, sampleRate)[0]->coefficients[0];
+				}
+			}));
+
+		add("makeHighCutFilter", getSlopeName(slope), measureSeconds([&]
+			{
+				for (int i = 0; i < numDesigns; ++i)
+				{
+					settings.highCutFreq = getFrequency(i);
+					benchmarkSink = benchmarkSink + makeHighCutFilter(settings, sampleRate)[0]->coefficients[0];
+				}
+			}));
+
+		// Both cut bands, as the designer thread does it
+		ChainCoefficients coefficients;
+
+		add("designChainCoefficients (cut bands)", getSlopeName(slope), measureSeconds([&]
+			{
+				for (int i = 0; i < numDesigns; ++i)
+				{
+					settings.lowCutFreq = settings.highCutFreq = getFrequency(i);
+					designChainCoefficients(coefficients, settings, sampleRate, LowCutBand | HighCutBand);
+					benchmarkSink = benchmarkSink + coefficients.lowCut[0].b0;
+				}
+			}));
+	}
+}
+
+// The response curve of the editor, one magnitude per pixel column with both cuts and one band of each type
+static void runResponseCurveBenchmarks(BenchmarkReport& report)
+{
+	constexpr int numCurves = 100;
+	constexpr double sampleRate = 48000.0;
+
+	// One band of every type
+	ChainSettings settings;
+	settings.lowCutSlope = settings.highCutSlope = Slope_48;
+
+	for (int band = 0; band < NumBandTypes; ++band)
+		settings.bands[(size_t)band] = { (BandType)band, 100.f * float(band + 1), 6.f, 1.f, false };
+
+	ChainCoefficients coefficients;
+	designChainCoefficients(coefficients, settings, sampleRate, AllBands);
+
+	for (auto width : { 600, 1200, 2400 })
+	{
+		std::vector<double> frequencies((size_t)width), decibels((size_t)width);
+
+		for (int i = 0; i < width; ++i)
+			frequencies[(size_t)i] = juce::mapToLog10(double(i) / double(width), 20.0, 20000.0);
+
+		const auto perFrequencySeconds = measureSeconds([&]
+			{
+				for (int curve = 0; curve < numCurves; ++curve)
+				{
+					for (int i = 0; i < width; ++i)
+						decibels[(size_t)i] = juce::Decibels::gainToDecibels(getChainMagnitudeForFrequency(coefficients, frequencies[(size_t)i], sampleRate));
+				}
+			});
+
+		ChainMagnitudeEvaluator evaluator;
+		evaluator.prepare(frequencies.data(), width, sampleRate);
+
+		const auto batchSeconds = measureSeconds([&]
+			{
+				for (int curve = 0; curve < numCurves; ++curve)
+					evaluator.process(coefficients, decibels.data());
+			});
+
+		benchmarkSink = benchmarkSink + decibels[0];
+
+		auto add = [&report, width](const char* method, double seconds)
+			{
+				report.add("response_curve", { { "method", method },
+					{ "width", width },
+					{ "us_per_curve", seconds * 1.0e6 / numCurves } });
+			};
+
+		add("getChainMagnitudeForFrequency", perFrequencySeconds);
+		add("ChainMagnitudeEvaluator", batchSeconds);
+	}
+}
+
+//==============================================================================
+static void runAnalyzerBenchmarks(BenchmarkReport& report)
+{
+	constexpr int numFrames = 200;
+	constexpr double sampleRate = 48000.0;
+
+	for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192, FFTOrder::order16384, FFTOrder::order32768 })
+	{
+		FFTDataGenerator<std::vector<float>> generator;
+		generator.changeOrder(order);
+
+		const auto fftSize = generator.getFFTSize();
+
+		juce::AudioBuffer<float> audio(1, fftSize);
+		juce::Random random(0x5eed);
+
+		for (int i = 0; i < fftSize; ++i)
+			audio.setSample(0, i, random.nextFloat() - 0.5f);
+
+		// Pulled after every frame so the fifo never fills up and skips the copy
+		std::vector<float> fftData;
+
+		const auto fftSeconds = measureSeconds([&]
+			{
+				for (int i = 0; i < numFrames; ++i)
+				{
+					generator.produceFFTDataForRendering(audio, -48.f);
+					generator.getFFTData(fftData);
+				}
+			});
+
+		report.add("produceFFTDataForRendering", { { "fft_size", fftSize },
+			{ "us_per_frame", fftSeconds * 1.0e6 / numFrames } });
+
+		for (auto width : { 600, 1200, 2400 })
+		{
+			AnalyzerTraceGenerator traceGenerator;
+			juce::Rectangle<float> bounds(0.f, 0.f, (float)width, 200.f);
+			AnalyzerTrace trace;
+
+			const auto traceSeconds = measureSeconds([&]
+				{
+					for (int i = 0; i < numFrames; ++i)
+						traceGenerator.generateTrace(fftData, bounds, fftSize, float(sampleRate / fftSize), -48.f, trace);
+				});
+
+			report.add("generateTrace", { { "fft_size", fftSize },
+				{ "width", width },
+				{ "us_per_frame", traceSeconds * 1.0e6 / numFrames } });
+		}
+	}
+}
+
+// What produceFFTDataForRendering did after the transform before convertMagnitudesToDecibels,
+// including the clear of the whole buffer before the transform
+static void legacyFFTPostProcessing(std::vector<float>& fftData, int fftSize, float negativeInfinity)
+{
+	std::vector<float> magnitudes(fftData.begin(), fftData.begin() + fftSize / 2);
+
+	fftData.assign(fftData.size(), 0);
+	std::copy(magnitudes.begin(), magnitudes.end(), fftData.begin());
+
+	const int numBins = fftSize / 2;
+
+	for (int i = 0; i < numBins; ++i)
+	{
+		auto v = fftData[(size_t)i];
+
+		if (!std::isinf(v) && !std::isnan(v))
+			v /= float(numBins);
+		else
+			v = 0.f;
+
+		fftData[(size_t)i] = v;
+	}
+
+	for (int i = 0; i < numBins; ++i)
+		fftData[(size_t)i] = juce::Decibels::gainToDecibels(fftData[(size_t)i], negativeInfinity);
+}
+
+static void runFFTPostProcessingBenchmarks(BenchmarkReport& report)
+{
+	constexpr int numFrames = 2000;
+	constexpr float negativeInfinity = -48.f;
+
+	for (int order : { 11, 12, 13 })
+	{
+		const auto fftSize = 1 << order;
+		const auto numBins = fftSize / 2;
+
+		// Magnitudes of a real transform of noise, so the levels are realistic
+		juce::dsp::FFT fft(order);
+		juce::Random random(0x5eed);
+		std::vector<float> magnitudes((size_t)fftSize * 2, 0.f);
+
+		for (int i = 0; i < fftSize; ++i)
+			magnitudes[(size_t)i] = random.nextFloat() - 0.5f;
+
+		fft.performFrequencyOnlyForwardTransform(magnitudes.data());
+
+		std::vector<float> legacy(magnitudes), fused(magnitudes);
+
+		// The copy back from 'magnitudes' is part of both, like the copy of the input samples is
+		const auto legacySeconds = measureSeconds([&]
+			{
+				for (int i = 0; i < numFrames; ++i)
+				{
+					std::copy(magnitudes.begin(), magnitudes.begin() + numBins, legacy.begin());
+					legacyFFTPostProcessing(legacy, fftSize, negativeInfinity);
+				}
+			});
+
+		const auto fusedSeconds = measureSeconds([&]
+			{
+				for (int i = 0; i < numFrames; ++i)
+				{
+					std::copy(magnitudes.begin(), magnitudes.begin() + numBins, fused.begin());
+					convertMagnitudesToDecibels(fused.data(), numBins, 1.f / float(numBins), negativeInfinity);
+				}
+			});
+
+		double maxError = 0.0;
+
+		for (int i = 0; i < numBins; ++i)
+			maxError = juce::jmax(maxError, (double)std::abs(legacy[(size_t)i] - fused[(size_t)i]));
+
+		report.add("fft_post_processing", { { "fft_size", fftSize },
+			{ "legacy_us_per_frame", legacySeconds * 1.0e6 / numFrames },
+			{ "fused_us_per_frame", fusedSeconds * 1.0e6 / numFrames },
+			{ "max_error_db", maxError } });
+	}
+}
+
+// One second of stereo audio arriving in small host blocks while the analyzer updates at 60 Hz
+static void runAnalyzerSchedulingBenchmarks(BenchmarkReport& report)
+{
+	constexpr double sampleRate = 48000.0;
+	constexpr int hostBlockSize = 64;
+	constexpr int samplesPerUpdate = int(sampleRate / 60.0);
+
+	juce::AudioBuffer<float> block(2, hostBlockSize);
+	juce::Random random(0x5eed);
+
+	for (int channel = 0; channel < 2; ++channel)
+		for (int i = 0; i < hostBlockSize; ++i)
+			block.setSample(channel, i, random.nextFloat() - 0.5f);
+
+	const juce::Rectangle<float> bounds(0.f, 0.f, 1200.f, 200.f);
+
+	auto add = [&report](const char* mode, float overlap, double seconds)
+		{
+			report.add("analyzer_scheduling", { { "mode", mode },
+				{ "overlap_percent", overlap },
+				{ "host_block_size", hostBlockSize },
+				{ "ms_per_second_of_audio", seconds * 1.0e3 } });
+		};
+
+	for (auto mode : { AnalyzerMode::latestFrame, AnalyzerMode::averageFrames })
+	{
+		for (auto overlap : { 0.f, 50.f, 75.f, 87.5f })
+		{
+			SingleChannelSampleFifo<juce::AudioBuffer<float>> tap(Channel::Left);
+			tap.prepare();
+
+			PathProducer producer(tap);
+			producer.setMode(mode);
+			producer.setOverlap(overlap);
+
+			const auto seconds = measureSeconds([&]
+				{
+					for (int written = 0; written < (int)sampleRate; written += hostBlockSize)
+					{
+						tap.update(block);
+
+						if ((written / hostBlockSize + 1) % (samplesPerUpdate / hostBlockSize) == 0)
+							producer.process(bounds, sampleRate);
+					}
+				}, 3);
+
+			add(mode == AnalyzerMode::latestFrame ? "latest_frame" : "average_frames", overlap, seconds);
+		}
+	}
+
+	// What the analyzer used to do: one FFT and path per host block
+	FFTDataGenerator<std::vector<float>> generator;
+	generator.changeOrder(FFTOrder::order2048);
+
+	AnalyzerTraceGenerator traceGenerator;
+	juce::AudioBuffer<float> monoBuffer(1, generator.getFFTSize());
+	std::vector<float> fftData;
+	AnalyzerTrace trace;
+
+	const auto perBlockSeconds = measureSeconds([&]
+		{
+			for (int written = 0; written < (int)sampleRate; written += hostBlockSize)
+			{
+				generator.produceFFTDataForRendering(monoBuffer, -48.f);
+				generator.getFFTData(fftData);
+				traceGenerator.generateTrace(fftData, bounds, generator.getFFTSize(), float(sampleRate / generator.getFFTSize()), -48.f, trace);
+			}
+		}, 3);
+
+	add("per_host_block", 100.f * (1.f - float(hostBlockSize) / (float)generator.getFFTSize()), perBlockSeconds);
+}
+
+//==============================================================================
+// Checks rather than measurements. Each one reports its results like the benchmarks
+// and returns false on failure, which makes the application exit with an error.
+
+// IDs of every parameter of the filter chain
+static juce::StringArray getChainParameterIDs(const juce::String& prefix)
+{
+	juce::StringArray ids;
+
+	for (auto* name : cutParameterNames)
+	{
+		ids.add(prefix + "LowCut " + name);
+		ids.add(prefix + "HighCut " + name);
+	}
+
+	for (int band = 0; band < maxParametricBands; ++band)
+		for (auto* name : bandParameterNames)
+			ids.add(prefix + getBandParameterID(band, name));
+
+	return ids;
+}
+
+// processBlock must neither allocate nor free while the host automates every parameter of both sets
+static int countProcessBlockAllocations(EqualizerAudioProcessor& processor)
+{
+	constexpr double sampleRate = 48000.0;
+	constexpr int blockSize = 256;
+	constexpr int numChannels = 2;
+	constexpr int numWarmUpBlocks = 50;
+	constexpr int numBlocks = 500;
+
+	processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+	processor.prepareToPlay(sampleRate, blockSize);
+
+	juce::Array<juce::AudioProcessorParameter*> automated;
+
+	for (const auto& prefix : { juce::String(), sideParameterPrefix })
+		for (const auto& id : getChainParameterIDs(prefix))
+			automated.add(processor.apvts.getParameter(id));
+
+	const auto noise = [&]
+		{
+			juce::AudioBuffer<float> samples(numChannels, blockSize);
+			juce::Random random(0x5eed);
+
+			for (int channel = 0; channel < numChannels; ++channel)
+				for (int i = 0; i < blockSize; ++i)
+					samples.setSample(channel, i, random.nextFloat() - 0.5f);
+
+			return samples;
+		}();
+
+	juce::AudioBuffer<float> buffer(numChannels, blockSize);
+	juce::MidiBuffer midi;
+
+	// What a host does for every automated parameter before each block, each one on its own sweep
+	auto processAutomatedBlock = [&](int block)
+		{
+			for (int i = 0; i < automated.size(); ++i)
+			{
+				const auto value = 0.5f + 0.5f * std::sin(0.05f * (float)block + (float)i);
+
+				automated.getUnchecked(i)->setValue(value);
+				automated.getUnchecked(i)->sendValueChangedMessageToListeners(value);
+			}
+
+			for (int channel = 0; channel < numChannels; ++channel)
+				buffer.copyFrom(channel, 0, noise, channel, 0, blockSize);
+
+			processor.processBlock(buffer, midi);
+		};
+
+	// Lets JUCE's listener lists and the designer settle first
+	for (int block = 0; block < numWarmUpBlocks; ++block)
+		processAutomatedBlock(block);
+
+	int numAllocations = 0;
+
+	{
+		ScopedAllocationCounter counter;
+
+		for (int block = 0; block < numBlocks; ++block)
+		{
+			processAutomatedBlock(numWarmUpBlocks + block);
+
+			// Gives the designer thread time to publish, so new coefficient sets get picked up
+			if (block % 50 == 0)
+				juce::Thread::sleep(10);
+		}
+
+		numAllocations = counter.getNumAllocations();
+	}
+
+	processor.releaseResources();
+	return numAllocations;
+}
+
+static bool runAllocationCheck(BenchmarkReport& report)
+{
+	struct Configuration
+	{
+		const char* name;
+		int smoothing;
+		bool linearPhase;
+		ProcessingMode processingMode;
+	};
+
+	static constexpr std::array<Configuration, 6> configurations{ {
+		{ "iir", 0, false, Stereo },
+		{ "iir_smoothing", 1, false, Stereo },
+		{ "linear_phase", 0, true, Stereo },
+		{ "iir_mid_side", 0, false, MidSide },
+		{ "iir_mid_side_smoothing", 1, false, MidSide },
+		{ "linear_phase_mid_side", 0, true, MidSide } } };
+
+	bool passed = true;
+
+	for (const auto& configuration : configurations)
+	{
+		EqualizerAudioProcessor processor;
+		setParameter(processor, "Smoothing", (float)configuration.smoothing);
+		setParameter(processor, "Linear Phase", configuration.linearPhase ? 1.f : 0.f);
+		setParameter(processor, "Processing Mode", (float)configuration.processingMode);
+
+		const auto numAllocations = countProcessBlockAllocations(processor);
+
+		report.add("allocations", { { "configuration", configuration.name },
+			{ "allocations", numAllocations },
+			{ "passed", numAllocations == 0 } });
+
+		if (numAllocations != 0)
+		{
+			std::cerr << "FAILED allocations (" << configuration.name << "): " << numAllocations
+				<< " allocations or frees in processBlock" << std::endl;
+			passed = false;
+		}
+	}
+
+	return passed;
+}
+
+// The SIMD chains in processBlock filter a group of channels in one pass. They have to match
+// what one scalar MonoChain per channel does with the same coefficients.
+static constexpr float simdTolerance = 1e-4f;
+
+// Same scaling as processBlock: mid and side are halved, decoding is a sum and difference
+static void encodeMidSide(juce::AudioBuffer<float>& buffer)
+{
+	for (int i = 0; i < buffer.getNumSamples(); ++i)
+	{
+		const auto l = buffer.getSample(0, i), r = buffer.getSample(1, i);
+		buffer.setSample(0, i, 0.5f * (l + r));
+		buffer.setSample(1, i, 0.5f * (l - r));
+	}
+}
+
+static void decodeMidSide(juce::AudioBuffer<float>& buffer)
+{
+	for (int i = 0; i < buffer.getNumSamples(); ++i)
+	{
+		const auto m = buffer.getSample(0, i), s = buffer.getSample(1, i);
+		buffer.setSample(0, i, m + s);
+		buffer.setSample(1, i, m - s);
+	}
+}
+
+static float getMaxSIMDDifference(EqualizerAudioProcessor& processor, int numChannels)
+{
+	constexpr double sampleRate = 48000.0;
+	constexpr int blockSize = 512;
+	constexpr int numBlocks = 48;
+
+	processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+	processor.prepareToPlay(sampleRate, blockSize);
+
+	// In Mid/Side mode mid and side share one SIMD pass with per lane coefficients,
+	// the scalar side channel gets the "Side ..." settings
+	const auto midSide = numChannels == 2 && processor.getProcessingMode(numChannels) == MidSide;
+
+	ChainCoefficients coefficients, sideCoefficients;
+	designChainCoefficients(coefficients, getChainSettings(processor.apvts), sampleRate, AllBands);
+	designChainCoefficients(sideCoefficients, getChainSettings(processor.apvts, sideParameterPrefix), sampleRate, AllBands);
+
+	std::vector<MonoChain> scalarChains((size_t)numChannels);
+
+	for (size_t channel = 0; channel < scalarChains.size(); ++channel)
+	{
+		scalarChains[channel].prepare({ sampleRate, (juce::uint32)blockSize, 1 });
+		updateChainFilters(scalarChains[channel], midSide && channel == 1 ? sideCoefficients : coefficients);
+	}
+
+	juce::AudioBuffer<float> buffer(numChannels, blockSize), expected(numChannels, blockSize);
+	juce::MidiBuffer midi;
+	juce::Random random(0x5eed);
+	float maxDifference = 0.f;
+
+	for (int block = 0; block < numBlocks; ++block)
+	{
+		for (int channel = 0; channel < numChannels; ++channel)
+			for (int i = 0; i < blockSize; ++i)
+				buffer.setSample(channel, i, random.nextFloat() - 0.5f);
+
+		expected.makeCopyOf(buffer, true);
+		processor.processBlock(buffer, midi);
+
+		if (midSide)
+			encodeMidSide(expected);
+
+		juce::dsp::AudioBlock<float> expectedBlock(expected);
+
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			auto channelBlock = expectedBlock.getSingleChannelBlock((size_t)channel);
+			scalarChains[(size_t)channel].process(juce::dsp::ProcessContextReplacing<float>(channelBlock));
+		}
+
+		if (midSide)
+			decodeMidSide(expected);
+
+		for (int channel = 0; channel < numChannels; ++channel)
+			for (int i = 0; i < blockSize; ++i)
+				maxDifference = juce::jmax(maxDifference, std::abs(buffer.getSample(channel, i) - expected.getSample(channel, i)));
+	}
+
+	processor.releaseResources();
+	return maxDifference;
+}
+
+static bool runSIMDCheck(BenchmarkReport& report)
+{
+	EqualizerAudioProcessor processor;
+	bool passed = true;
+
+	auto check = [&](const juce::String& setting, int numChannels)
+		{
+			const auto maxDifference = getMaxSIMDDifference(processor, numChannels);
+			const auto withinTolerance = maxDifference <= simdTolerance;
+
+			report.add("simd_vs_scalar", { { "setting", setting },
+				{ "num_channels", numChannels },
+				{ "max_difference", maxDifference },
+				{ "tolerance", simdTolerance },
+				{ "passed", withinTolerance } });
+
+			if (!withinTolerance)
+			{
+				std::cerr << "FAILED simd_vs_scalar (" << setting << ", " << numChannels << " channels): max difference "
+					<< maxDifference << " exceeds " << simdTolerance << std::endl;
+				passed = false;
+			}
+		};
+
+	setParameter(processor, "LowCut Freq", 40.f);
+	setParameter(processor, "HighCut Freq", 15000.f);
+	setParameter(processor, getBandParameterID(0, "Gain"), 6.f);
+
+	for (int lowCutSlope = 0; lowCutSlope < NumSlopes; ++lowCutSlope)
+	{
+		for (int highCutSlope = 0; highCutSlope < NumSlopes; ++highCutSlope)
+		{
+			setParameter(processor, "LowCut Slope", (float)lowCutSlope);
+			setParameter(processor, "HighCut Slope", (float)highCutSlope);
+
+			check(getSlopeName(lowCutSlope) + " / " + getSlopeName(highCutSlope), 2);
+		}
+	}
+
+	// Four bands of each type, also with enough channels for a second, partly filled SIMD group
+	auto* typeParameter = dynamic_cast<juce::AudioParameterChoice*>(processor.apvts.getParameter(getBandParameterID(0, "Type")));
+
+	for (int type = 0; type < NumBandTypes; ++type)
+	{
+		for (int band = 0; band < 4; ++band)
+		{
+			setParameter(processor, getBandParameterID(band, "Bypassed"), 0.f);
+			setParameter(processor, getBandParameterID(band, "Type"), (float)type);
+			setParameter(processor, getBandParameterID(band, "Freq"), 100.f * std::pow(4.f, (float)band));
+			setParameter(processor, getBandParameterID(band, "Gain"), band % 2 == 0 ? 9.f : -9.f);
+		}
+
+		check(typeParameter->choices[type], 2);
+		check(typeParameter->choices[type], (int)SIMDSample::size() + 1);
+	}
+
+	// Mid/Side with side settings that differ in every section: other slopes, a bypassed
+	// low cut and bands that are only active in one of the two lanes
+	setParameter(processor, "Processing Mode", (float)MidSide);
+	setParameter(processor, sideParameterPrefix + "LowCut Bypassed", 1.f);
+	setParameter(processor, sideParameterPrefix + "HighCut Freq", 8000.f);
+	setParameter(processor, sideParameterPrefix + "HighCut Slope", (float)(NumSlopes - 1));
+
+	for (int band = 2; band < 6; ++band)
+	{
+		setParameter(processor, sideParameterPrefix + getBandParameterID(band, "Bypassed"), 0.f);
+		setParameter(processor, sideParameterPrefix + getBandParameterID(band, "Freq"), 60.f * std::pow(3.f, (float)band));
+		setParameter(processor, sideParameterPrefix + getBandParameterID(band, "Gain"), band % 2 == 0 ? -6.f : 12.f);
+	}
+
+	check("Mid/Side", 2);
+
+	setParameter(processor, "Processing Mode", (float)Stereo);
+
+	return passed;
+}
+
+//==============================================================================
+static const char* usage =
+	"Usage: EqualizerBenchmarks [--output <file>] [benchmarks...]\n"
+	"\n"
+	"  Writes the results as JSON to <file>, or to stdout.\n"
+	"  benchmarks: any of kernels, processBlock, design, analyzer, checks (default: all)\n"
+	"  Exits with 1 if one of the checks fails.\n";
+
+int main(int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+	juce::ScopedNoDenormals noDenormals;
+
+	juce::ArgumentList arguments(argc, argv);
+
+	if (arguments.containsOption("--help|-h"))
+	{
+		std::cout << usage;
+		return 0;
+	}
+
+	juce::File outputFile;
+
+	if (arguments.containsOption("--output"))
+		outputFile = arguments.getFileForOptionAndRemove("--output");
+
+	auto shouldRun = [&arguments](const char* name)
+		{
+			return arguments.size() == 0 || arguments.indexOfOption(name) >= 0;
+		};
+
+	BenchmarkReport report;
+
+	if (shouldRun("kernels"))
+		runKernelBenchmarks(report);
+
+	if (shouldRun("processBlock"))
+		runProcessBlockBenchmarks(report);
+
+	if (shouldRun("design"))
+	{
+		runCoefficientDesignBenchmarks(report);
+		runResponseCurveBenchmarks(report);
+	}
+
+	if (shouldRun("analyzer"))
+	{
+		runAnalyzerBenchmarks(report);
+		runFFTPostProcessingBenchmarks(report);
+		runAnalyzerSchedulingBenchmarks(report);
+	}
+
+	bool checksPassed = true;
+
+	if (shouldRun("checks"))
+	{
+		checksPassed = runAllocationCheck(report) && checksPassed;
+		checksPassed = runSIMDCheck(report) && checksPassed;
+	}
+
+	const auto json = report.toJSON();
+
+	if (outputFile == juce::File())
+	{
+		std::cout << json << std::endl;
+	}
+	else if (!outputFile.replaceWithText(json))
+	{
+		std::cerr << "Couldn't write " << outputFile.getFullPathName() << std::endl;
+		return 1;
+	}
+
+	return checksPassed ? 0 : 1;
+}
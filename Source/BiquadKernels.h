@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    Second order filter kernels used by the processing chain.
+
+    Every kernel takes the same normalised BiquadCoefficients and processes a
+    single channel block of SampleType, where SampleType is either float or a
+    juce::dsp::SIMDRegister<float> holding one sample of several channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <complex>
+
+// Raw, normalised (a0 == 1) biquad coefficients which can be copied around without allocating.
+// They're designed in double precision, each kernel keeps whatever precision it needs.
+struct BiquadCoefficients
+{
+	double b0{ 1.0 }, b1{ 0.0 }, b2{ 0.0 }, a1{ 0.0 }, a2{ 0.0 };
+};
+
+// Magnitude response of one section at 'frequency'
+inline double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate)
+{
+	const auto z1 = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+	const auto z2 = z1 * z1;
+
+	const auto numerator = coefficients.b0 + coefficients.b1 * z1 + coefficients.b2 * z2;
+	const auto denominator = 1.0 + coefficients.a1 * z1 + coefficients.a2 * z2;
+
+	return std::abs(numerator / denominator);
+}
+
+//==============================================================================
+// Every lane of a SIMDRegister sample is a channel of its own, and every kernel can give
+// each lane its own coefficients, e.g. to filter mid and side in one pass.
+// A plain float sample has a single lane.
+template<typename SampleType>
+constexpr size_t getNumLanes()
+{
+	return sizeof(SampleType) / sizeof(typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type);
+}
+
+template<typename SampleType, typename NumericType>
+void setLane(SampleType& sample, size_t lane, NumericType value)
+{
+	if constexpr (std::is_floating_point_v<SampleType>)
+	{
+		juce::ignoreUnused(lane);
+		jassert(lane == 0);
+		sample = value;
+	}
+	else
+	{
+		sample.set(lane, value);
+	}
+}
+
+//==============================================================================
+// Transposed direct form II with coefficients and state in the sample precision.
+// The cheapest kernel, but with float samples the poles of low cut-offs at high
+// sample rates sit close enough to the unit circle for the rounding to become audible.
+template<typename SampleType>
+struct TDF2Biquad
+{
+	using NumericType = typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type;
+
+	TDF2Biquad() { setCoefficients(BiquadCoefficients{}); }
+
+	void prepare(const juce::dsp::ProcessSpec&) { reset(); }
+
+	void reset()
+	{
+		s1 = NumericType(0);
+		s2 = NumericType(0);
+	}
+
+	void reset(size_t lane)
+	{
+		setLane(s1, lane, NumericType(0));
+		setLane(s2, lane, NumericType(0));
+	}
+
+	// The same coefficients for every lane
+	void setCoefficients(const BiquadCoefficients& coefficients)
+	{
+		b0 = NumericType(coefficients.b0);
+		b1 = NumericType(coefficients.b1);
+		b2 = NumericType(coefficients.b2);
+		a1 = NumericType(coefficients.a1);
+		a2 = NumericType(coefficients.a2);
+	}
+
+	void setCoefficients(size_t lane, const BiquadCoefficients& coefficients)
+	{
+		setLane(b0, lane, NumericType(coefficients.b0));
+		setLane(b1, lane, NumericType(coefficients.b1));
+		setLane(b2, lane, NumericType(coefficients.b2));
+		setLane(a1, lane, NumericType(coefficients.a1));
+		setLane(a2, lane, NumericType(coefficients.a2));
+	}
+
+	void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+	{
+		if (context.isBypassed)
+			return;
+
+		auto& block = context.getOutputBlock();
+		jassert(block.getNumChannels() == 1);
+
+		auto* samples = block.getChannelPointer(0);
+		auto state1 = s1, state2 = s2;
+
+		for (size_t i = 0; i < block.getNumSamples(); ++i)
+		{
+			auto x = samples[i];
+			auto y = x * b0 + state1;
+
+			state1 = x * b1 - y * a1 + state2;
+			state2 = x * b2 - y * a2;
+
+			samples[i] = y;
+		}
+
+		s1 = state1;
+		s2 = state2;
+	}
+
+private:
+	SampleType b0{}, b1{}, b2{}, a1{}, a2{};
+	SampleType s1{}, s2{};
+};
+
+//==============================================================================
+// Transposed direct form II with double precision coefficients and state.
+// The samples stay in SampleType, so each lane is widened to double on the fly.
+template<typename SampleType>
+struct DoubleTDF2Biquad
+{
+	using NumericType = typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type;
+	static constexpr size_t numLanes = getNumLanes<SampleType>();
+
+	void prepare(const juce::dsp::ProcessSpec&) { reset(); }
+
+	void reset()
+	{
+		s1.fill(0.0);
+		s2.fill(0.0);
+	}
+
+	void reset(size_t lane)
+	{
+		s1[lane] = 0.0;
+		s2[lane] = 0.0;
+	}
+
+	// The same coefficients for every lane
+	void setCoefficients(const BiquadCoefficients& newCoefficients)
+	{
+		coefficients.fill(newCoefficients);
+	}
+
+	void setCoefficients(size_t lane, const BiquadCoefficients& newCoefficients)
+	{
+		coefficients[lane] = newCoefficients;
+	}
+
+	void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+	{
+		if (context.isBypassed)
+			return;
+
+		auto& block = context.getOutputBlock();
+		jassert(block.getNumChannels() == 1);
+
+		auto* samples = reinterpret_cast<NumericType*>(block.getChannelPointer(0));
+
+		for (size_t i = 0; i < block.getNumSamples(); ++i)
+		{
+			auto* frame = samples + i * numLanes;
+
+			for (size_t lane = 0; lane < numLanes; ++lane)
+			{
+				const auto& c = coefficients[lane];
+				const auto x = static_cast<double>(frame[lane]);
+				const auto y = c.b0 * x + s1[lane];
+
+				s1[lane] = c.b1 * x - c.a1 * y + s2[lane];
+				s2[lane] = c.b2 * x - c.a2 * y;
+
+				frame[lane] = static_cast<NumericType>(y);
+			}
+		}
+	}
+
+private:
+	std::array<BiquadCoefficients, numLanes> coefficients;
+	std::array<double, numLanes> s1{}, s2{};
+};
+
+//==============================================================================
+// Trapezoidal state variable filter (Simper), fed with the same biquad coefficients.
+// Its states are integrator outputs rather than delayed sums, which keeps low
+// cut-offs far better conditioned than TDF-II at the same precision.
+template<typename SampleType>
+struct SVFBiquad
+{
+	using NumericType = typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type;
+
+	SVFBiquad() { setCoefficients(BiquadCoefficients{}); }
+
+	void prepare(const juce::dsp::ProcessSpec&) { reset(); }
+
+	void reset()
+	{
+		ic1eq = NumericType(0);
+		ic2eq = NumericType(0);
+	}
+
+	void reset(size_t lane)
+	{
+		setLane(ic1eq, lane, NumericType(0));
+		setLane(ic2eq, lane, NumericType(0));
+	}
+
+	// The same coefficients for every lane
+	void setCoefficients(const BiquadCoefficients& c)
+	{
+		const auto g = getGains(c);
+
+		a1 = NumericType(g.a1);
+		a2 = NumericType(g.a2);
+		a3 = NumericType(g.a3);
+
+		m0 = NumericType(g.m0);
+		m1 = NumericType(g.m1);
+		m2 = NumericType(g.m2);
+	}
+
+	void setCoefficients(size_t lane, const BiquadCoefficients& c)
+	{
+		const auto g = getGains(c);
+
+		setLane(a1, lane, NumericType(g.a1));
+		setLane(a2, lane, NumericType(g.a2));
+		setLane(a3, lane, NumericType(g.a3));
+
+		setLane(m0, lane, NumericType(g.m0));
+		setLane(m1, lane, NumericType(g.m1));
+		setLane(m2, lane, NumericType(g.m2));
+	}
+
+	void process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+	{
+		if (context.isBypassed)
+			return;
+
+		auto& block = context.getOutputBlock();
+		jassert(block.getNumChannels() == 1);
+
+		auto* samples = block.getChannelPointer(0);
+		auto state1 = ic1eq, state2 = ic2eq;
+
+		for (size_t i = 0; i < block.getNumSamples(); ++i)
+		{
+			auto v0 = samples[i];
+			auto v3 = v0 - state2;
+			auto v1 = state1 * a1 + v3 * a2;
+			auto v2 = state2 + state1 * a2 + v3 * a3;
+
+			state1 = v1 * NumericType(2) - state1;
+			state2 = v2 * NumericType(2) - state2;
+
+			samples[i] = v0 * m0 + v1 * m1 + v2 * m2;
+		}
+
+		ic1eq = state1;
+		ic2eq = state2;
+	}
+
+private:
+	struct Gains
+	{
+		double a1, a2, a3, m0, m1, m2;
+	};
+
+	static Gains getGains(const BiquadCoefficients& c)
+	{
+		// Solve for the SVF whose bilinear transform gives the same denominator,
+		// then for the high/band/low-pass mix which gives the same numerator
+		const auto denominator = 1.0 - c.a1 + c.a2;
+		const auto g = juce::jmax(1.0e-9, std::sqrt(juce::jmax(0.0, (1.0 + c.a1 + c.a2) / denominator)));
+		const auto k = 2.0 * (1.0 - c.a2) / (denominator * g);
+
+		const auto highPassGain = (c.b0 - c.b1 + c.b2) / denominator;
+		const auto bandPassGain = 2.0 * (c.b0 - c.b2) / (denominator * g);
+		const auto lowPassGain = (c.b0 + c.b1 + c.b2) / (denominator * g * g);
+
+		const auto a1d = 1.0 / (1.0 + g * (g + k));
+
+		return { a1d, g * a1d, g * g * a1d,
+			highPassGain, bandPassGain - k * highPassGain, lowPassGain - highPassGain };
+	}
+
+	SampleType a1{}, a2{}, a3{};
+	SampleType m0{}, m1{}, m2{};
+	SampleType ic1eq{}, ic2eq{};
+};
+
+//==============================================================================
+// Kernel used for every section of the chain, e.g. set EQUALIZER_BIQUAD_KERNEL=1 in the
+// exporter's preprocessor definitions when filtering at very high sample rates.
+//   0 = TDF2Biquad, 1 = DoubleTDF2Biquad, 2 = SVFBiquad
+#ifndef EQUALIZER_BIQUAD_KERNEL
+ #define EQUALIZER_BIQUAD_KERNEL 0
+#endif
+
+template<typename SampleType>
+#if EQUALIZER_BIQUAD_KERNEL == 1
+using Filter = DoubleTDF2Biquad<SampleType>;
+#elif EQUALIZER_BIQUAD_KERNEL == 2
+using Filter = SVFBiquad<SampleType>;
+#else
+using Filter = TDF2Biquad<SampleType>;
+#endif
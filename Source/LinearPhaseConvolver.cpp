@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    Linear phase mode: turns the magnitude response of the chain into an FIR
+    kernel and applies it with uniformly partitioned overlap-save convolution.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseConvolver.h"
+
+int getLinearPhaseKernelLength(double sampleRate)
+{
+	const auto length = juce::nextPowerOfTwo((int)std::ceil(8192.0 * sampleRate / 48000.0));
+	return juce::jlimit(8192, 65536, length);
+}
+
+int getLinearPhaseLatencySamples(double sampleRate)
+{
+	return linearPhasePartitionSize + getLinearPhaseKernelLength(sampleRate) / 2;
+}
+
+//==============================================================================
+void LinearPhaseKernel::prepare(int newPartitionSize, int newNumPartitions)
+{
+	partitionSize = newPartitionSize;
+	numPartitions = newNumPartitions;
+
+	real.assign((size_t)(numPartitions * getNumBins()), 0.f);
+	imag.assign((size_t)(numPartitions * getNumBins()), 0.f);
+}
+
+//==============================================================================
+void LinearPhaseDesigner::prepare(double newSampleRate, int newKernelLength, int newPartitionSize)
+{
+	jassert(juce::isPowerOfTwo(newKernelLength) && juce::isPowerOfTwo(newPartitionSize));
+	jassert(newKernelLength >= newPartitionSize);
+
+	sampleRate = newSampleRate;
+	kernelLength = newKernelLength;
+	partitionSize = newPartitionSize;
+
+	kernelFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(kernelLength)));
+	partitionFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * partitionSize)));
+
+	impulseResponse.assign((size_t)kernelLength, 0.f);
+	fftBuffer.assign((size_t)(2 * kernelLength), 0.f);
+
+	// Blackman, symmetric around the kernel's centre tap
+	window.resize((size_t)kernelLength);
+	for (int n = 0; n < kernelLength; ++n)
+	{
+		const auto phase = juce::MathConstants<double>::twoPi * n / kernelLength;
+		window[(size_t)n] = (float)(0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+	}
+}
+
+void LinearPhaseDesigner::design(LinearPhaseKernel& destination, const MagnitudeFunction& getMagnitudeForFrequency)
+{
+	jassert(kernelFFT != nullptr);
+
+	// Sample the magnitude response with a delay of half the kernel, i.e. (-1)^k,
+	// in the interleaved layout performRealOnlyInverseTransform expects
+	std::fill(fftBuffer.begin(), fftBuffer.end(), 0.f);
+
+	for (int bin = 0; bin <= kernelLength / 2; ++bin)
+	{
+		const auto frequency = bin * sampleRate / kernelLength;
+		const auto magnitude = getMagnitudeForFrequency(frequency);
+
+		fftBuffer[(size_t)(2 * bin)] = (float)((bin & 1) != 0 ? -magnitude : magnitude);
+	}
+
+	kernelFFT->performRealOnlyInverseTransform(fftBuffer.data());
+
+	// Windowing trades the ripple of the truncated response for a little smoothing
+	for (int n = 0; n < kernelLength; ++n)
+		impulseResponse[(size_t)n] = fftBuffer[(size_t)n] * window[(size_t)n];
+
+	partition(destination);
+}
+
+void LinearPhaseDesigner::designDelay(LinearPhaseKernel& destination)
+{
+	std::fill(impulseResponse.begin(), impulseResponse.end(), 0.f);
+	impulseResponse[(size_t)(kernelLength / 2)] = 1.f;
+
+	partition(destination);
+}
+
+void LinearPhaseDesigner::partition(LinearPhaseKernel& destination)
+{
+	const auto numPartitions = kernelLength / partitionSize;
+
+	if (destination.partitionSize != partitionSize || destination.numPartitions != numPartitions)
+		destination.prepare(partitionSize, numPartitions);
+
+	for (int p = 0; p < numPartitions; ++p)
+	{
+		std::fill(fftBuffer.begin(), fftBuffer.begin() + 4 * partitionSize, 0.f);
+		std::copy_n(impulseResponse.begin() + p * partitionSize, partitionSize, fftBuffer.begin());
+
+		partitionFFT->performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+		auto* real = destination.getReal(p);
+		auto* imag = destination.getImag(p);
+
+		for (int bin = 0; bin < destination.getNumBins(); ++bin)
+		{
+			real[bin] = fftBuffer[(size_t)(2 * bin)];
+			imag[bin] = fftBuffer[(size_t)(2 * bin + 1)];
+		}
+	}
+}
+
+//==============================================================================
+void PartitionedConvolver::prepare(int newPartitionSize, int newNumPartitions)
+{
+	partitionSize = newPartitionSize;
+	numPartitions = newNumPartitions;
+
+	const auto numBins = (size_t)(partitionSize + 1);
+
+	inputBuffer.resize((size_t)(2 * partitionSize));
+	outputBuffer.resize((size_t)partitionSize);
+	fadeFromBuffer.resize((size_t)partitionSize);
+	fftBuffer.resize((size_t)(4 * partitionSize));
+
+	delayLineReal.resize(numBins * (size_t)numPartitions);
+	delayLineImag.resize(numBins * (size_t)numPartitions);
+	accumulatorReal.resize(numBins);
+	accumulatorImag.resize(numBins);
+
+	reset();
+}
+
+void PartitionedConvolver::reset()
+{
+	std::fill(inputBuffer.begin(), inputBuffer.end(), 0.f);
+	std::fill(outputBuffer.begin(), outputBuffer.end(), 0.f);
+	std::fill(delayLineReal.begin(), delayLineReal.end(), 0.f);
+	std::fill(delayLineImag.begin(), delayLineImag.end(), 0.f);
+
+	inputPosition = 0;
+	newestPartition = 0;
+	fadeFromKernel = nullptr;
+}
+
+void PartitionedConvolver::process(float* samples, int numSamples, const LinearPhaseKernel& kernel, const juce::dsp::FFT& fft)
+{
+	jassert(kernel.partitionSize == partitionSize && kernel.numPartitions == numPartitions);
+	jassert(fft.getSize() == 2 * partitionSize);
+
+	while (numSamples > 0)
+	{
+		const auto numToCopy = juce::jmin(numSamples, partitionSize - inputPosition);
+
+		// The output of the previous partition goes out while this one fills up
+		std::copy_n(samples, numToCopy, inputBuffer.begin() + partitionSize + inputPosition);
+		std::copy_n(outputBuffer.begin() + inputPosition, numToCopy, samples);
+
+		inputPosition += numToCopy;
+		samples += numToCopy;
+		numSamples -= numToCopy;
+
+		if (inputPosition == partitionSize)
+		{
+			processPartition(kernel, fft);
+			inputPosition = 0;
+		}
+	}
+}
+
+void PartitionedConvolver::processPartition(const LinearPhaseKernel& kernel, const juce::dsp::FFT& fft)
+{
+	const auto numBins = partitionSize + 1;
+
+	std::copy(inputBuffer.begin(), inputBuffer.end(), fftBuffer.begin());
+	fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+	newestPartition = (newestPartition + 1) % numPartitions;
+
+	auto* newestReal = delayLineReal.data() + newestPartition * numBins;
+	auto* newestImag = delayLineImag.data() + newestPartition * numBins;
+
+	for (int bin = 0; bin < numBins; ++bin)
+	{
+		newestReal[bin] = fftBuffer[(size_t)(2 * bin)];
+		newestImag[bin] = fftBuffer[(size_t)(2 * bin + 1)];
+	}
+
+	convolve(kernel, fft, outputBuffer.data());
+
+	// The input spectra don't depend on the kernel, so the previous kernel's output for
+	// this partition only costs a second multiply-accumulate and inverse transform
+	if (fadeFromKernel != nullptr)
+	{
+		convolve(*fadeFromKernel, fft, fadeFromBuffer.data());
+
+		for (int i = 0; i < partitionSize; ++i)
+		{
+			const auto gain = float(i + 1) / float(partitionSize);
+			outputBuffer[(size_t)i] = fadeFromBuffer[(size_t)i] + gain * (outputBuffer[(size_t)i] - fadeFromBuffer[(size_t)i]);
+		}
+
+		fadeFromKernel = nullptr;
+	}
+
+	std::copy_n(inputBuffer.begin() + partitionSize, partitionSize, inputBuffer.begin());
+}
+
+void PartitionedConvolver::convolve(const LinearPhaseKernel& kernel, const juce::dsp::FFT& fft, float* output)
+{
+	const auto numBins = partitionSize + 1;
+
+	// Multiply-accumulate every input spectrum with its kernel partition, the
+	// newest input against the first partition. Split real/imaginary parts keep
+	// the inner loop free of shuffles, so it vectorises.
+	std::fill(accumulatorReal.begin(), accumulatorReal.end(), 0.f);
+	std::fill(accumulatorImag.begin(), accumulatorImag.end(), 0.f);
+
+	auto* accReal = accumulatorReal.data();
+	auto* accImag = accumulatorImag.data();
+
+	for (int p = 0; p < numPartitions; ++p)
+	{
+		const auto delayed = (newestPartition - p + numPartitions) % numPartitions;
+
+		const auto* xr = delayLineReal.data() + delayed * numBins;
+		const auto* xi = delayLineImag.data() + delayed * numBins;
+		const auto* hr = kernel.getReal(p);
+		const auto* hi = kernel.getImag(p);
+
+		for (int bin = 0; bin < numBins; ++bin)
+		{
+			accReal[bin] += xr[bin] * hr[bin] - xi[bin] * hi[bin];
+			accImag[bin] += xr[bin] * hi[bin] + xi[bin] * hr[bin];
+		}
+	}
+
+	for (int bin = 0; bin < numBins; ++bin)
+	{
+		fftBuffer[(size_t)(2 * bin)] = accReal[bin];
+		fftBuffer[(size_t)(2 * bin + 1)] = accImag[bin];
+	}
+
+	fft.performRealOnlyInverseTransform(fftBuffer.data());
+
+	// Overlap-save: the first half wrapped around, the second half is valid
+	std::copy_n(fftBuffer.begin() + partitionSize, partitionSize, output);
+}
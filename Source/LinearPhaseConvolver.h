@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    Linear phase mode: turns the magnitude response of the chain into an FIR
+    kernel and applies it with uniformly partitioned overlap-save convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <functional>
+#include <vector>
+
+// Input is collected in blocks of this many samples, which is also the latency added on
+// top of the kernel's own delay of half its length
+static constexpr int linearPhasePartitionSize = 512;
+
+// Long enough for ~6 Hz resolution at any sample rate, between 8k and 64k taps
+int getLinearPhaseKernelLength(double sampleRate);
+int getLinearPhaseLatencySamples(double sampleRate);
+
+//==============================================================================
+// An FIR kernel split into partitions of 'partitionSize' taps, each stored as the
+// spectrum of the zero padded partition (partitionSize + 1 bins, split into real and imaginary parts)
+struct LinearPhaseKernel
+{
+	void prepare(int newPartitionSize, int newNumPartitions);
+
+	int getNumBins() const { return partitionSize + 1; }
+
+	float* getReal(int partition) { return real.data() + (size_t)(partition * getNumBins()); }
+	float* getImag(int partition) { return imag.data() + (size_t)(partition * getNumBins()); }
+	const float* getReal(int partition) const { return real.data() + (size_t)(partition * getNumBins()); }
+	const float* getImag(int partition) const { return imag.data() + (size_t)(partition * getNumBins()); }
+
+	int partitionSize = 0, numPartitions = 0;
+
+	// Counter value of the "Linear Phase" switch the kernel was designed after, see CoefficientDesigner::isKernelUpToDate()
+	int linearPhaseSwitch = -1;
+
+private:
+	std::vector<float> real, imag;
+};
+
+//==============================================================================
+// Designs linear phase kernels by frequency sampling. Allocates in prepare() only,
+// but the design itself is far too slow for the audio thread.
+struct LinearPhaseDesigner
+{
+	// Returns the linear magnitude response at a frequency in Hz
+	using MagnitudeFunction = std::function<double(double)>;
+
+	void prepare(double newSampleRate, int newKernelLength, int newPartitionSize);
+
+	void design(LinearPhaseKernel& destination, const MagnitudeFunction& getMagnitudeForFrequency);
+
+	// A pure delay of half the kernel length, i.e. the latency without any filtering
+	void designDelay(LinearPhaseKernel& destination);
+
+private:
+	void partition(LinearPhaseKernel& destination);
+
+	double sampleRate = 44100.0;
+	int kernelLength = 0, partitionSize = 0;
+
+	std::unique_ptr<juce::dsp::FFT> kernelFFT, partitionFFT;
+	std::vector<float> impulseResponse, window, fftBuffer;
+};
+
+//==============================================================================
+// Uniformly partitioned overlap-save convolution of a single channel. Allocation free after prepare().
+struct PartitionedConvolver
+{
+	void prepare(int newPartitionSize, int newNumPartitions);
+	void reset();
+
+	// 'fft' has to be of size 2 * partitionSize
+	void process(float* samples, int numSamples, const LinearPhaseKernel& kernel, const juce::dsp::FFT& fft);
+
+	// The kernel passed to process() takes over at the next partition boundary. That partition is
+	// convolved with both kernels and faded from 'previous' to the new one, so a kernel change
+	// doesn't click. 'previous' has to stay valid for as long as isCrossfading() returns true.
+	void crossfadeFrom(const LinearPhaseKernel& previous) { fadeFromKernel = &previous; }
+	bool isCrossfading() const { return fadeFromKernel != nullptr; }
+
+private:
+	void processPartition(const LinearPhaseKernel& kernel, const juce::dsp::FFT& fft);
+
+	// Multiplies the delay line with 'kernel' and writes the valid half of the result to 'output'
+	void convolve(const LinearPhaseKernel& kernel, const juce::dsp::FFT& fft, float* output);
+
+	int partitionSize = 0, numPartitions = 0;
+	int inputPosition = 0, newestPartition = 0;
+
+	const LinearPhaseKernel* fadeFromKernel = nullptr;
+
+	// Last two blocks of input, so each FFT overlaps the previous one by half
+	std::vector<float> inputBuffer;
+	std::vector<float> outputBuffer, fadeFromBuffer;
+	std::vector<float> fftBuffer;
+
+	// Frequency domain delay line, one spectrum per partition
+	std::vector<float> delayLineReal, delayLineImag;
+	std::vector<float> accumulatorReal, accumulatorImag;
+};
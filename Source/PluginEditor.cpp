@@ -228,9 +228,7 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(EqualizerAudioProcessor& p) : 
 audioProcessor(p), 
-//leftChannelFifo(&audioProcessor.leftChannelFifo)
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo)
+analyzer(p)
 {
 	const auto& params = audioProcessor.getParameters();
 	for (auto param : params)
@@ -238,18 +236,29 @@ rightPathProducer(audioProcessor.rightChannelFifo)
 		param->addListener(this);
 	}
 
+	audioProcessor.analyzerSettings.addListener(this);
+	analyzer.setSettings(AnalyzerSettings::fromValueTree(audioProcessor.analyzerSettings));
+
 	updateChain();
 
-	startTimerHz(60);
+	// The static layer covers every pixel
+	setOpaque(true);
+
+	analyzer.setMaximumFrameRate(frameDriver->getMaximumFrameRate());
+	frameDriver->addClient(this);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
+	frameDriver->removeClient(this);
+
 	const auto& params = audioProcessor.getParameters();
 	for (auto param : params)
 	{
 		param->removeListener(this);
 	}
+
+	audioProcessor.analyzerSettings.removeListener(this);
 }
 
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
@@ -257,196 +266,893 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
 	parametersChanged.set(true);
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+void ResponseCurveComponent::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property)
+{
+	// The analyzer thread rebuilds its FFTs itself, this only hands the settings over
+	analyzer.setSettings(AnalyzerSettings::fromValueTree(tree));
+}
+
+//==============================================================================
+bool BinToPixelMap::update(int newWidth, int newFFTSize, float newBinWidth)
+{
+	if (newWidth == getNumColumns() && newFFTSize == fftSize && newBinWidth == binWidth)
+		return false;
+
+	fftSize = newFFTSize;
+	binWidth = newBinWidth;
+	columns.resize((size_t)juce::jmax(0, newWidth));
+
+	const auto numBins = fftSize / 2;
+
+	for (int x = 0; x < newWidth; ++x)
+	{
+		const auto lowFreq = juce::mapToLog10((double)x / newWidth, 20.0, 20000.0);
+		const auto highFreq = juce::mapToLog10((double)(x + 1) / newWidth, 20.0, 20000.0);
+
+		// Bins whose centre frequency lies in [lowFreq, highFreq)
+		const auto firstBin = juce::jlimit(0, numBins, (int)std::ceil(lowFreq / binWidth));
+		const auto endBin = juce::jlimit(0, numBins, (int)std::ceil(highFreq / binWidth));
+
+		auto& column = columns[(size_t)x];
+		column.firstBin = firstBin;
+		column.numBins = endBin - firstBin;
+		column.centreBin = juce::jlimit(0.f, (float)(numBins - 1), (float)(std::sqrt(lowFreq * highFreq) / binWidth));
+	}
+
+	return true;
+}
+
+float BinToPixelMap::getColumnValue(const float* bins, int x, BinReduction reduction) const
 {
-	// Sending samples to FFT data generator
-	juce::AudioBuffer<float> tempIncomingBuffer;
+	const auto& column = columns[(size_t)x];
 
-	while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
+	if (column.numBins == 0)
 	{
-		if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
+		// Catmull-Rom through the four nearest bins, smooth where straight lines between bins would be jaggy
+		const auto lastBin = fftSize / 2 - 1;
+		const auto bin = (int)column.centreBin;
+		const auto t = column.centreBin - (float)bin;
+
+		const auto p0 = bins[juce::jmax(bin - 1, 0)];
+		const auto p1 = bins[bin];
+		const auto p2 = bins[juce::jmin(bin + 1, lastBin)];
+		const auto p3 = bins[juce::jmin(bin + 2, lastBin)];
+
+		return p1 + 0.5f * t * (p2 - p0 + t * (2.f * p0 - 5.f * p1 + 4.f * p2 - p3 + t * (3.f * (p1 - p2) + p3 - p0)));
+	}
+
+	const auto* first = bins + column.firstBin;
+	const auto* last = first + column.numBins;
+
+	switch (reduction)
+	{
+	case BinReduction::minimum: return *std::min_element(first, last);
+	case BinReduction::mean:    return std::accumulate(first, last, 0.f) / (float)column.numBins;
+	case BinReduction::maximum:
+	default:                    return *std::max_element(first, last);
+	}
+}
+
+//==============================================================================
+juce::StringArray AnalyzerSettings::getModeNames() { return { "Latest Frame", "Average Frames" }; }
+juce::StringArray AnalyzerSettings::getOverlapNames() { return { "No Overlap", "50% Overlap", "75% Overlap", "87.5% Overlap" }; }
+juce::StringArray AnalyzerSettings::getResolutionNames() { return { "48 Hz", "24 Hz", "12 Hz", "6 Hz", "3 Hz", "1.5 Hz" }; }
+juce::StringArray AnalyzerSettings::getWindowNames() { return { "Rectangular", "Hann", "Hamming", "Blackman", "Blackman-Harris", "Flat Top" }; }
+juce::StringArray AnalyzerSettings::getAveragingNames() { return { "No Averaging", "Exponential", "Peak Hold" }; }
+juce::StringArray AnalyzerSettings::getDecayRateNames() { return { "3 dB/s", "6 dB/s", "12 dB/s", "24 dB/s", "48 dB/s", "96 dB/s" }; }
+
+AnalyzerSettings AnalyzerSettings::fromValueTree(const juce::ValueTree& tree)
+{
+	// Ids out of range (e.g. from a newer version) fall back to the nearest option
+	auto getIndex = [&tree](const char* property, int defaultId, int numOptions)
 		{
-			auto size = tempIncomingBuffer.getNumSamples();
+			return (size_t)(juce::jlimit(1, numOptions, (int)tree.getProperty(property, defaultId)) - 1);
+		};
 
-			juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-				monoBuffer.getReadPointer(0, size),
-				monoBuffer.getNumSamples() - size);
+	AnalyzerSettings settings;
+	settings.mode = modes[getIndex("Mode", defaultModeId, (int)modes.size())];
+	settings.overlap = overlaps[getIndex("Overlap", defaultOverlapId, (int)overlaps.size())];
+	settings.resolution = resolutions[getIndex("Resolution", defaultResolutionId, (int)resolutions.size())];
+	settings.window = windows[getIndex("Window", defaultWindowId, (int)windows.size())];
+	settings.averaging = (AnalyzerAveraging)getIndex("Averaging", defaultAveragingId, getAveragingNames().size());
+	settings.decayRate = decayRates[getIndex("Decay", defaultDecayId, (int)decayRates.size())];
 
-			juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-				tempIncomingBuffer.getReadPointer(0, 0),
-				size);
+	return settings;
+}
 
-			leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
-		}
+FFTOrder getAnalyzerOrderForResolution(double resolution, double sampleRate, WindowingMethod window)
+{
+	// Equivalent noise bandwidth of the window in bins: wider main lobes need longer FFTs for the same resolution
+	auto getBandwidthInBins = [window]()
+		{
+			switch (window)
+			{
+			case WindowingMethod::rectangular:    return 1.0;
+			case WindowingMethod::hann:           return 1.5;
+			case WindowingMethod::hamming:        return 1.36;
+			case WindowingMethod::blackman:       return 1.73;
+			case WindowingMethod::blackmanHarris: return 2.0;
+			case WindowingMethod::flatTop:        return 3.77;
+			default:                              return 2.0;
+			}
+		};
+
+	for (auto order : { order2048, order4096, order8192, order16384, order32768 })
+	{
+		if (getBandwidthInBins() * sampleRate / (double)(1 << order) <= resolution)
+			return order;
 	}
 
-	// Producing Paths from FFT dataGen
-	// if there are FFT data buffer to pull
-	//   if we can pull a buffer
-	//     generate a path
+	return order32768;
+}
+
+//==============================================================================
+void PathProducer::configure(FFTOrder order, WindowingMethod window)
+{
+	const auto oldSize = monoBuffer.getNumSamples();
+
+	if (oldSize > 0 && order == currentOrder && window == currentWindow)
+		return;
+
+	currentOrder = order;
+	currentWindow = window;
+
+	leftChannelFFTDataGenerator.changeOrder(order, window);
 	const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-	const auto binWidth = sampleRate / (double)fftSize;  // Sample Rate / FFT size <- bin width
 
-	while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+	// The newest samples stay at the end, so the display carries on without a gap
+	juce::AudioBuffer<float> newMonoBuffer(1, fftSize);
+	newMonoBuffer.clear();
+
+	const auto numToKeep = juce::jmin(oldSize, fftSize);
+	if (numToKeep > 0)
+		newMonoBuffer.copyFrom(0, fftSize - numToKeep, monoBuffer, 0, oldSize - numToKeep, numToKeep);
+
+	monoBuffer = std::move(newMonoBuffer);
+
+	fftData.assign((size_t)fftSize * 2, 0.f);
+	averagedFFTData.assign(fftData.size(), 0.f);
+	displayData.assign(fftData.size(), 0.f);
+	displayNeedsReset = true;
+	displayIsSettled = false;
+
+	setOverlap(overlapPercent);
+}
+
+void PathProducer::applyAveraging(const std::vector<float>& frame, double secondsSinceLastFrame)
+{
+	const auto numBins = leftChannelFFTDataGenerator.getFFTSize() / 2;
+
+	if (displayNeedsReset)
+	{
+		std::copy_n(frame.begin(), numBins, displayData.begin());
+		displayNeedsReset = false;
+		return;
+	}
+
+	if (averaging == AnalyzerAveraging::exponential)
+	{
+		// Time constant of 6 dB over the decay rate, e.g. 0.25 s at 24 dB/s
+		const auto timeConstant = 6.0 / (double)decayRate;
+		const auto alpha = (float)(1.0 - std::exp(-secondsSinceLastFrame / timeConstant));
+
+		for (int bin = 0; bin < numBins; ++bin)
+			displayData[(size_t)bin] += alpha * (frame[(size_t)bin] - displayData[(size_t)bin]);
+	}
+	else
+	{
+		const auto fall = (float)(decayRate * secondsSinceLastFrame);
+
+		for (int bin = 0; bin < numBins; ++bin)
+			displayData[(size_t)bin] = juce::jmax(frame[(size_t)bin], displayData[(size_t)bin] - fall);
+	}
+}
+
+bool PathProducer::isDisplayAtFloor() const
+{
+	const auto numBins = leftChannelFFTDataGenerator.getFFTSize() / 2;
+	return juce::FloatVectorOperations::findMaximum(displayData.data(), numBins) <= floorDecibels + 0.5f;
+}
+
+bool PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+{
+	if (!leftChannelFifo->isPrepared())
+		return false;
+
+	// Sending samples to FFT data generator one hop at a time, reading them straight into the end of monoBuffer
+	const auto totalSize = monoBuffer.getNumSamples();
+	const auto numHops = leftChannelFifo->getNumSamplesAvailable() / hopSize;
+
+	// After a stall, hops more than one window older than the newest one can't show up in the display.
+	// They're still read, so nothing is dropped, but not analysed.
+	const auto numHopsToAnalyse = (totalSize + hopSize - 1) / hopSize;
+
+	// The ballistics need every frame to run at the right speed
+	const auto analyseEveryHop = mode == AnalyzerMode::averageFrames || averaging != AnalyzerAveraging::off;
+
+	// The trace has to be generated again for new bounds, even from silence
+	if (fftBounds != lastBounds)
+	{
+		lastBounds = fftBounds;
+		displayIsSettled = false;
+	}
+
+	bool hasNewFFTData = false;
+	int numAveraged = 0;
+
+	for (int hop = 0; hop < numHops; ++hop)
 	{
-		std::vector<float> fftData;
-		if (leftChannelFFTDataGenerator.getFFTData(fftData))
+		auto* mono = monoBuffer.getWritePointer(0);
+
+		// The regions overlap, so this can't be a FloatVectorOperations::copy
+		std::copy(mono + hopSize, mono + totalSize, mono);
+		leftChannelFifo->pull(mono + totalSize - hopSize, hopSize);
+
+		++hopsSinceLastFrame;
+
+		const auto hopRange = juce::FloatVectorOperations::findMinAndMax(mono + totalSize - hopSize, hopSize);
+		numSilentSamples = juce::jmax(-hopRange.getStart(), hopRange.getEnd()) > silenceThreshold ? 0 : numSilentSamples + hopSize;
+
+		const auto windowIsSilent = numSilentSamples >= totalSize;
+
+		if (windowIsSilent && displayIsSettled)
+		{
+			hopsSinceLastFrame = 0;
+			continue;
+		}
+
+		const auto isNewest = hop == numHops - 1;
+
+		if (numHops - hop > numHopsToAnalyse || (!analyseEveryHop && !isNewest))
+			continue;
+
+		leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, floorDecibels);
+
+		// Pulled straight away, so the fifo never fills up and the newest frame always gets through
+		if (!leftChannelFFTDataGenerator.getFFTData(fftData))
+			continue;
+
+		hasNewFFTData = true;
+
+		if (averaging != AnalyzerAveraging::off)
+		{
+			applyAveraging(fftData, hopsSinceLastFrame * hopSize / sampleRate);
+		}
+		else if (mode == AnalyzerMode::averageFrames)
 		{
-			pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+			if (numAveraged == 0)
+				std::copy(fftData.begin(), fftData.end(), averagedFFTData.begin());
+			else
+				juce::FloatVectorOperations::add(averagedFFTData.data(), fftData.data(), (int)fftData.size());
+
+			++numAveraged;
 		}
+
+		hopsSinceLastFrame = 0;
+
+		// A silent window shows the floor, and so does the display once the averaging has decayed there
+		displayIsSettled = windowIsSilent && (averaging == AnalyzerAveraging::off || isDisplayAtFloor());
 	}
 
-	//Pulling paths
-	while (pathProducer.getNumPathsAvailable())
+	if (numAveraged > 1)
+		juce::FloatVectorOperations::multiply(fftData.data(), averagedFFTData.data(), 1.f / (float)numAveraged, (int)fftData.size());
+
+	// One trace per update at most, any more would be replaced before being painted
+	if (hasNewFFTData)
 	{
-		pathProducer.getPath(leftChannelFFTPath);
+		const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
+		const auto binWidth = sampleRate / (double)fftSize;  // Sample Rate / FFT size <- bin width
+
+		traceGenerator.generateTrace(averaging != AnalyzerAveraging::off ? displayData : fftData, fftBounds, fftSize, binWidth, floorDecibels, trace);
 	}
+
+	return hasNewFFTData;
 }
 
-void ResponseCurveComponent::timerCallback()
+//==============================================================================
+static juce::PropertiesFile::Options getGlobalSettingsOptions()
 {
-	if (shouldShowFFTAnalysis)
+	juce::PropertiesFile::Options options;
+	options.applicationName = "Equalizer";
+	options.filenameSuffix = ".settings";
+	options.folderName = "Equalizer";
+	options.osxLibrarySubFolder = "Application Support";
+
+	return options;
+}
+
+FrameDriver::FrameDriver() :
+	settings(getGlobalSettingsOptions())
+{
+	const auto savedFrameRate = settings.getIntValue("frameRateLimit", defaultFrameRate);
+
+	if (std::find(frameRates.begin(), frameRates.end(), savedFrameRate) != frameRates.end())
+		maximumFrameRate = savedFrameRate;
+}
+
+FrameDriver::~FrameDriver()
+{
+	stopTimer();
+}
+
+void FrameDriver::addClient(Client* client)
+{
+	clients.add(client);
+
+	if (!isTimerRunning())
+		startTimerHz(maximumFrameRate);
+}
+
+void FrameDriver::removeClient(Client* client)
+{
+	clients.remove(client);
+
+	if (clients.isEmpty())
+		stopTimer();
+}
+
+void FrameDriver::setMaximumFrameRate(int framesPerSecond)
+{
+	maximumFrameRate = framesPerSecond;
+
+	settings.setValue("frameRateLimit", maximumFrameRate);
+	settings.saveIfNeeded();
+
+	if (isTimerRunning())
+		startTimerHz(maximumFrameRate);
+}
+
+void FrameDriver::timerCallback()
+{
+	clients.call([](Client& client) { client.frameCallback(); });
+}
+
+//==============================================================================
+std::shared_ptr<const juce::dsp::FFT> AnalyzerTables::getFFT(int order)
+{
+	const juce::ScopedLock sl(lock);
+
+	if (auto existing = ffts[order].lock())
+		return existing;
+
+	std::shared_ptr<const juce::dsp::FFT> fft = std::make_shared<juce::dsp::FFT>(order);
+	ffts[order] = fft;
+
+	return fft;
+}
+
+std::shared_ptr<const std::vector<float>> AnalyzerTables::getWindow(int size, WindowingMethod method)
+{
+	const juce::ScopedLock sl(lock);
+
+	auto& cached = windows[{ size, method }];
+
+	if (auto existing = cached.lock())
+		return existing;
+
+	auto table = std::make_shared<std::vector<float>>((size_t)size);
+	juce::dsp::WindowingFunction<float>::fillWindowingTables(table->data(), (size_t)size, method, true);
+
+	std::shared_ptr<const std::vector<float>> window = table;
+	cached = window;
+
+	return window;
+}
+
+//==============================================================================
+AnalyzerService::AnalyzerService()
+{
+	const auto numWorkers = juce::jlimit(1, 4, juce::SystemStats::getNumCpus() / 2);
+
+	for (int i = 0; i < numWorkers; ++i)
+		workers.add(new Worker(*this))->startThread();
+}
+
+AnalyzerService::~AnalyzerService()
+{
+	for (auto* worker : workers)
+		worker->signalThreadShouldExit();
+
 	{
-		auto fftBounds = getAnalysisArea().toFloat();
-		auto sampleRate = audioProcessor.getSampleRate();
+		const std::lock_guard<std::mutex> lock(mutex);
+		jobsChanged.notify_all();
+	}
+
+	for (auto* worker : workers)
+		worker->stopThread(1000);
+}
 
-		leftPathProducer.process(fftBounds, sampleRate);
-		rightPathProducer.process(fftBounds, sampleRate);
+void AnalyzerService::addJob(AnalyzerJob* job)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+
+	jobs.push_back({ job, juce::Time::getMillisecondCounter(), false });
+	jobsChanged.notify_all();
+}
+
+void AnalyzerService::removeJob(AnalyzerJob* job)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	auto isThisJob = [job](const ScheduledJob& scheduled) { return scheduled.job == job; };
+
+	jobsChanged.wait(lock, [this, &isThisJob]()
+		{
+			auto scheduled = std::find_if(jobs.begin(), jobs.end(), isThisJob);
+			return scheduled == jobs.end() || !scheduled->isRunning;
+		});
+
+	jobs.erase(std::remove_if(jobs.begin(), jobs.end(), isThisJob), jobs.end());
+}
+
+AnalyzerJob* AnalyzerService::takeNextJob(Worker& worker)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (!worker.threadShouldExit())
+	{
+		const auto now = juce::Time::getMillisecondCounter();
+		auto waitMs = maxWaitMs;
+
+		// Starting after the job taken last, so the busiest editors can't starve the others
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			auto& scheduled = jobs[(nextJob + i) % jobs.size()];
+
+			if (scheduled.isRunning || !scheduled.job->isEnabled())
+				continue;
+
+			const auto elapsedMs = (int)(now - scheduled.lastRunMs);
+			const auto intervalMs = scheduled.job->getIntervalMs();
+
+			if (elapsedMs >= intervalMs)
+			{
+				scheduled.isRunning = true;
+				scheduled.lastRunMs = now;
+				nextJob = (nextJob + i + 1) % jobs.size();
+
+				return scheduled.job;
+			}
+
+			waitMs = juce::jmin(waitMs, intervalMs - elapsedMs);
+		}
+
+		jobsChanged.wait_for(lock, std::chrono::milliseconds(waitMs));
+	}
+
+	return nullptr;
+}
+
+void AnalyzerService::finishJob(AnalyzerJob* job)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto& scheduled : jobs)
+	{
+		if (scheduled.job == job)
+			scheduled.isRunning = false;
+	}
+
+	jobsChanged.notify_all();
+}
+
+void AnalyzerService::Worker::run()
+{
+	while (auto* job = service.takeNextJob(*this))
+	{
+		job->run();
+		service.finishJob(job);
+	}
+}
+
+//==============================================================================
+AnalyzerJob::AnalyzerJob(EqualizerAudioProcessor& p) :
+	audioProcessor(p),
+	leftPathProducer(p.leftChannelFifo),
+	rightPathProducer(p.rightChannelFifo)
+{
+	service->addJob(this);
+}
+
+AnalyzerJob::~AnalyzerJob()
+{
+	service->removeJob(this);
+}
+
+void AnalyzerJob::run()
+{
+	// Empty until the editor was laid out
+	boundsBuffer.pull();
+	const auto bounds = boundsBuffer.getReadBuffer();
+
+	if (bounds.isEmpty())
+		return;
+
+	const auto sampleRate = audioProcessor.getSampleRate();
+
+	if (sampleRate <= 0.0)
+		return;
+
+	applySettings(sampleRate);
+
+	// Both are called every time, so neither channel's tap backs up
+	const auto leftChanged = leftPathProducer.process(bounds, sampleRate);
+	const auto rightChanged = rightPathProducer.process(bounds, sampleRate);
+
+	if (!leftChanged && !rightChanged)
+		return;
+
+	// Plain copies of fixed size arrays, nothing is allocated
+	auto& traces = traceBuffer.getWriteBuffer();
+	traces.left = leftPathProducer.getTrace();
+	traces.right = rightPathProducer.getTrace();
+	traceBuffer.publish();
+}
+
+void AnalyzerJob::setSettings(const AnalyzerSettings& settings)
+{
+	mode.store(settings.mode);
+	overlap.store(settings.overlap);
+	resolution.store(settings.resolution);
+	window.store(settings.window);
+	averaging.store(settings.averaging);
+	decayRate.store(settings.decayRate);
+}
+
+void AnalyzerJob::applySettings(double sampleRate)
+{
+	// The cheapest FFT giving the requested resolution at the current sample rate
+	const auto windowingMethod = window.load();
+	const auto order = getAnalyzerOrderForResolution(resolution.load(), sampleRate, windowingMethod);
+	const auto maxHopSize = juce::jmax(1, (int)(sampleRate / minFramesPerSecond));
+
+	for (auto* producer : { &leftPathProducer, &rightPathProducer })
+	{
+		producer->configure(order, windowingMethod);
+		producer->setMode(mode.load());
+		producer->setOverlap(overlap.load(), maxHopSize);
+		producer->setAveraging(averaging.load(), decayRate.load());
+	}
+}
+
+void ResponseCurveComponent::frameCallback()
+{
+	// Hidden editors (closed, minimised or behind another tab) neither analyse nor paint.
+	// Parameter changes wait in parametersChanged until the editor shows up again.
+	const auto showing = isShowing();
+	analyzer.setEnabled(shouldShowFFTAnalysis && showing);
+
+	if (!showing)
+		return;
+
+	analyzer.setMaximumFrameRate(frameDriver->getMaximumFrameRate());
+
+	// The analysis itself runs on analyzer, this only picks up the newest traces.
+	// Nothing is repainted unless something changed, and then only the area it's in.
+	if (shouldShowFFTAnalysis && analyzer.pull())
+		repaint(getAnalysisArea());
+
+	// The overrun counter is drawn over the traces, so it has to show up even when no new trace arrives
+	const auto numOverruns = getNumAnalyzerOverruns();
+	if (numOverruns != lastNumAnalyzerOverruns)
+	{
+		lastNumAnalyzerOverruns = numOverruns;
+		repaint(getAnalysisArea());
 	}
 
 	//Updating the curve
 	if (parametersChanged.compareAndSetBool(false, true))
 	{
 		updateChain();
+		updateResponseCurve();
 
-		/*repaint();*/
+		repaint(getRenderArea());
 	}
-	repaint();
 }
 
-void ResponseCurveComponent::updateChain()
+void ResponseCurveComponent::mouseDown(const juce::MouseEvent& event)
+{
+	if (!event.mods.isPopupMenu())
+	{
+		// The nearest marker within a few pixels
+		const auto& markedSettings = getMarkedSettings();
+		auto nearestBand = -1;
+		auto nearestDistance = 8.f;
+
+		for (int band = 0; band < maxParametricBands; ++band)
+		{
+			const auto& bandSettings = markedSettings.bands[(size_t)band];
+
+			if (bandSettings.bypassed)
+				continue;
+
+			if (const auto distance = getBandMarkerPosition(bandSettings).getDistanceFrom(event.position); distance < nearestDistance)
+			{
+				nearestBand = band;
+				nearestDistance = distance;
+			}
+		}
+
+		if (nearestBand >= 0 && onBandClicked != nullptr)
+			onBandClicked(nearestBand);
+
+		return;
+	}
+
+	juce::PopupMenu menu;
+	menu.addSectionHeader("Frame Rate Limit (all instances)");
+
+	auto safePtr = juce::Component::SafePointer<ResponseCurveComponent>(this);
+
+	for (auto frameRate : FrameDriver::frameRates)
+	{
+		menu.addItem(juce::String(frameRate) + " fps", true, frameRate == frameDriver->getMaximumFrameRate(), [safePtr, frameRate]()
+			{
+				if (auto* comp = safePtr.getComponent())
+					comp->frameDriver->setMaximumFrameRate(frameRate);
+			});
+	}
+
+	menu.showMenuAsync(juce::PopupMenu::Options());
+}
+
+void ResponseCurveComponent::mouseDoubleClick(const juce::MouseEvent& event)
 {
-	auto chainSettings = getChainSettings(audioProcessor.apvts);
+	const auto area = getAnalysisArea().toFloat();
 
-	monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-	monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-	monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+	if (!area.contains(event.position) || onAddBand == nullptr)
+		return;
 
-	auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-	updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+	const auto freq = juce::mapToLog10((event.position.x - area.getX()) / area.getWidth(), 20.f, 20000.f);
+	const auto gainInDecibels = juce::jmap(event.position.y, area.getBottom(), area.getY(), -24.f, 24.f);
 
-	auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-	auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+	onAddBand(freq, gainInDecibels);
+}
 
-	updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-	updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+void ResponseCurveComponent::setSelectedBand(const juce::String& parameterPrefix, int band)
+{
+	if (parameterPrefix == markedPrefix && band == selectedBand)
+		return;
+
+	markedPrefix = parameterPrefix;
+	selectedBand = band;
+
+	// The markers of the other set may not have been designed yet
+	parametersChanged.set(true);
 }
 
-void ResponseCurveComponent::paint(juce::Graphics& g)
+const ChainSettings& ResponseCurveComponent::getMarkedSettings() const
+{
+	return markedPrefix.isEmpty() ? chainCoefficients.settings : sideChainCoefficients.settings;
+}
+
+juce::Point<float> ResponseCurveComponent::getBandMarkerPosition(const BandSettings& bandSettings)
 {
-	// Creating and painting a response curve
+	const auto area = getAnalysisArea().toFloat();
+	const auto x = area.getX() + area.getWidth() * (float)juce::mapFromLog10((double)bandSettings.freq, 20.0, 20000.0);
+
+	// The curve goes through 0 dB at the frequency of the types without a gain, and of tilts
+	const auto hasGain = bandSettings.type == Bell || bandSettings.type == LowShelf || bandSettings.type == HighShelf;
+	const auto y = juce::jmap(hasGain ? bandSettings.gainInDecibels : 0.f, -24.f, 24.f, area.getBottom(), area.getY());
 
+	return { x, y };
+}
+
+void ResponseCurveComponent::updateChain()
+{
+	auto& apvts = audioProcessor.apvts;
+	auto sampleRate = audioProcessor.getSampleRate();
+
+	designChainCoefficients(chainCoefficients, getChainSettings(apvts), sampleRate, AllBands);
+
+	showsSideCurve = audioProcessor.getProcessingMode(audioProcessor.getTotalNumOutputChannels()) == MidSide;
+
+	if (showsSideCurve || markedPrefix.isNotEmpty())
+		designChainCoefficients(sideChainCoefficients, getChainSettings(apvts, sideParameterPrefix), sampleRate, AllBands);
+}
+
+void ResponseCurveComponent::updateResponseCurve()
+{
+	// Rebuilt only when the parameters or the size change, paint() just draws the cached layer
 	using namespace juce;
-	g.fillAll(Colours::black);
 
-	g.drawImage(background, getLocalBounds().toFloat());
+	responseCurve.clear();
+	sideResponseCurve.clear();
+	curveLayerNeedsUpdate = true;
 
 	auto responseArea = getAnalysisArea();
 	
 	auto width = responseArea.getWidth();
 
-	auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-	auto& peak = monoChain.get<ChainPositions::Peak>();
-	auto& highcut = monoChain.get<ChainPositions::HighCut>();
+	if (width <= 0)
+		return;
 
 	auto sampleRate = audioProcessor.getSampleRate();
 
-	std::vector<double> mags;
-
-	mags.resize(width);
-
-	for (int i = 0; i < width; i++)
+	// The frequency grid only changes with the width or the sample rate
+	if (magnitudeEvaluator.getNumFrequencies() != width || curveSampleRate != sampleRate)
 	{
-		double mag = 1.f;
-		auto freq = mapToLog10(double(i) / double(width), 20.0, 20000.0);
+		std::vector<double> freqs((size_t)width);
 
-		if (!monoChain.isBypassed<ChainPositions::Peak>())
-			mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+		for (int i = 0; i < width; i++)
+			freqs[i] = mapToLog10(double(i) / double(width), 20.0, 20000.0);
 
-		if (!monoChain.isBypassed<ChainPositions::LowCut>())
-		{
-			if (!lowcut.isBypassed<0>())
-				mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (!lowcut.isBypassed<1>())
-				mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (!lowcut.isBypassed<2>())
-				mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (!lowcut.isBypassed<3>())
-				mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		}
-
-		if (!monoChain.isBypassed<ChainPositions::HighCut>())
-		{
-			if (!highcut.isBypassed<0>())
-				mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (!highcut.isBypassed<1>())
-				mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (!highcut.isBypassed<2>())
-				mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (!highcut.isBypassed<3>())
-				mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		}
-		mags[i] = Decibels::gainToDecibels(mag);
+		magnitudeEvaluator.prepare(freqs.data(), width, sampleRate);
+		curveSampleRate = sampleRate;
+		mags.resize(width);
 	}
 
-	Path responseCurve;
-
 	const double outputMin = responseArea.getBottom();
 	const double outputMax = responseArea.getY();
 	auto map = [outputMin, outputMax](double input)
 		{
 			return jmap(input, -24.0, 24.0, outputMin, outputMax);
 		};
-	responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
 
-	for (size_t i = 1; i < mags.size(); i++)
+	auto buildCurve = [&](const ChainCoefficients& coefficients, Path& curve)
+		{
+			magnitudeEvaluator.process(coefficients, mags.data());
+
+			curve.startNewSubPath(responseArea.getX(), map(mags.front()));
+
+			for (size_t i = 1; i < mags.size(); i++)
+			{
+				curve.lineTo(responseArea.getX() + i, map(mags[i]));
+			}
+		};
+
+	buildCurve(chainCoefficients, responseCurve);
+
+	if (showsSideCurve)
+		buildCurve(sideChainCoefficients, sideResponseCurve);
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+	// Compositing the cached layers: grid, analyzer, then border and response curve
+
+	using namespace juce;
+	const auto startTicks = Time::getHighResolutionTicks();
+
+	// The layers have as many pixels as the display, so they're drawn 1:1 without resampling.
+	// The scale changes when the window moves to another display.
+	const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+	if (staticLayer.isNull() || scale != layerScale)
+	{
+		layerScale = scale;
+		renderStaticLayer();
+		curveLayerNeedsUpdate = true;
+	}
+
+	if (curveLayerNeedsUpdate)
 	{
-		responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
+		renderCurveLayer();
+		curveLayerNeedsUpdate = false;
 	}
 
+	const auto bounds = getLocalBounds().toFloat();
+
+	// Opaque and covering the whole component, so nothing is painted underneath it
+	g.drawImage(staticLayer, bounds);
+
 	// Drawing Spectrum Analyzer if button is enabled
 	if (shouldShowFFTAnalysis)
 	{
 		// Skyblue left channel
-		auto leftChannelFFTPath = leftPathProducer.getPath();
-		leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+		const auto& analyzerTraces = analyzer.getLatest();
+
+		analyzerTraces.left.toPath(analyzerPath);
 		g.setColour(Colours::skyblue);
-		g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
+		g.strokePath(analyzerPath, PathStrokeType(1.f));
 
 		// Yellow right channel 
-		auto rightChannelFFTPath = rightPathProducer.getPath();
-		rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+		analyzerTraces.right.toPath(analyzerPath);
 		g.setColour(Colours::lightyellow);
-		g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+		g.strokePath(analyzerPath, PathStrokeType(1.f));
 	}
 
+	g.drawImage(curveLayer, bounds);
+
+	frameTimeCounter.addFrame(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks));
+
+#if EQUALIZER_SHOW_FRAME_TIME
+	g.setColour(Colours::lightgrey);
+	g.setFont(10.f);
+	g.drawText(String(frameTimeCounter.getAverageMilliseconds(), 2) + " ms avg, " + String(frameTimeCounter.getMaxMilliseconds(), 2) + " ms max",
+		getAnalysisArea().reduced(4), Justification::bottomRight, false);
+#endif
+
+	drawAnalyzerOverruns(g);
+}
+
+void ResponseCurveComponent::resized()
+{
+	analyzer.setAnalysisBounds(getAnalysisArea().toFloat());
+	updateResponseCurve();
+
+	// Both layers are rendered again in the next paint, at the display's scale
+	staticLayer = juce::Image();
+}
+
+void ResponseCurveComponent::renderCurveLayer()
+{
+	using namespace juce;
+	curveLayer = Image(Image::PixelFormat::ARGB, staticLayer.getWidth(), staticLayer.getHeight(), true);
+
+	Graphics g(curveLayer);
+	g.addTransform(AffineTransform::scale(layerScale));
+
 	// White rectangle with the response curve in it
 	g.setColour(Colours::white);
 	g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
 
-	// Blueviolet response curve
+	// Orange side curve in Mid/Side mode, under the main one
+	g.setColour(Colours::orange);
+	g.strokePath(sideResponseCurve, PathStrokeType(2.f));
+
+	// Blueviolet response curve, built in updateResponseCurve()
 	g.setColour(Colours::blueviolet);
 	g.strokePath(responseCurve, PathStrokeType(2.f));
+
+	// A marker on every active band of the edited set, the selected one filled
+	const auto& markedSettings = getMarkedSettings();
+
+	for (int band = 0; band < maxParametricBands; ++band)
+	{
+		const auto& bandSettings = markedSettings.bands[(size_t)band];
+
+		if (bandSettings.bypassed)
+			continue;
+
+		const auto marker = Rectangle<float>(10.f, 10.f).withCentre(getBandMarkerPosition(bandSettings));
+
+		g.setColour(Colours::white);
+
+		if (band == selectedBand)
+			g.fillEllipse(marker);
+		else
+			g.drawEllipse(marker, 1.5f);
+	}
 }
 
-void ResponseCurveComponent::resized()
+int ResponseCurveComponent::getNumAnalyzerOverruns() const
+{
+	// Both taps are filled from the same blocks, so they fall behind together
+	return juce::jmax(audioProcessor.leftChannelFifo.getNumOverruns(), audioProcessor.rightChannelFifo.getNumOverruns());
+}
+
+void ResponseCurveComponent::drawAnalyzerOverruns(juce::Graphics& g)
+{
+	const auto numOverruns = getNumAnalyzerOverruns();
+
+	if (!shouldShowFFTAnalysis || numOverruns == 0)
+		return;
+
+	const auto& left = audioProcessor.leftChannelFifo;
+	const auto& right = audioProcessor.rightChannelFifo;
+	const auto numDroppedSamples = juce::jmax(left.getNumDroppedSamples(), right.getNumDroppedSamples());
+
+	g.setColour(juce::Colours::lightgrey);
+	g.setFont(10.f);
+	g.drawText("Analyzer fell behind " + juce::String(numOverruns) + " times, " + juce::String(numDroppedSamples) + " samples dropped",
+		getAnalysisArea().reduced(4), juce::Justification::bottomLeft, false);
+}
+
+void ResponseCurveComponent::renderStaticLayer()
 {
 	//Drawing a grid with params
 
 	using namespace juce;
-	background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
+	staticLayer = Image(Image::PixelFormat::RGB,
+		jmax(1, roundToInt(getWidth() * layerScale)),
+		jmax(1, roundToInt(getHeight() * layerScale)),
+		true);
+
+	Graphics g(staticLayer);
+	g.addTransform(AffineTransform::scale(layerScale));
 
-	Graphics g(background);
+	g.fillAll(Colours::black);
 	
 	// Vertical lines are frequencies
 
@@ -582,36 +1288,27 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea()
 //==============================================================================
 EqualizerAudioProcessorEditor::EqualizerAudioProcessorEditor(EqualizerAudioProcessor& p)
 	: AudioProcessorEditor(&p), audioProcessor(p),
-	peakFreqSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "Hz"),
-	peakGainSlider(*audioProcessor.apvts.getParameter("Peak Gain"), "dB"),
-	peakQualitySlider(*audioProcessor.apvts.getParameter("Peak Quality"), ""),
+	bandFreqSlider(*audioProcessor.apvts.getParameter(getBandParameterID(0, "Freq")), "Hz"),
+	bandGainSlider(*audioProcessor.apvts.getParameter(getBandParameterID(0, "Gain")), "dB"),
+	bandQualitySlider(*audioProcessor.apvts.getParameter(getBandParameterID(0, "Quality")), ""),
 	lowCutFreqSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
 	highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
 	lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Oct"),
 	highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "db/Oct"),
 
 	responseCurveComponent(audioProcessor),
-	peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
-	peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
-	peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
-	lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
-	highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-	lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-	highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider),
 
-	lowCutBypassButtonAttachment(audioProcessor.apvts, "LowCut Bypassed", lowCutBypassButton),
-	peakBypassButtonAttachment(audioProcessor.apvts, "Peak Bypassed", peakBypassButton),
-	highCutBypassButtonAttachment(audioProcessor.apvts, "HighCut Bypassed", highCutBypassButton),
-	analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton)
+	analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton),
+	linearPhaseButtonAttachment(audioProcessor.apvts, "Linear Phase", linearPhaseButton)
 {
-	peakFreqSlider.labels.add({ 0.f, "20Hz" });
-	peakFreqSlider.labels.add({ 1.f, "20kHz" });
+	bandFreqSlider.labels.add({ 0.f, "20Hz" });
+	bandFreqSlider.labels.add({ 1.f, "20kHz" });
 
-	peakGainSlider.labels.add({ 0.f, "-24dB" });
-	peakGainSlider.labels.add({ 1.f, "+24dB" });
+	bandGainSlider.labels.add({ 0.f, "-24dB" });
+	bandGainSlider.labels.add({ 1.f, "+24dB" });
 
-	peakQualitySlider.labels.add({ 0.f,"0.1" });
-	peakQualitySlider.labels.add({ 1.f,"10.0" });
+	bandQualitySlider.labels.add({ 0.f,"0.1" });
+	bandQualitySlider.labels.add({ 1.f,"10.0" });
 
 	lowCutFreqSlider.labels.add({ 0.f,"20Hz" });
 	lowCutFreqSlider.labels.add({ 1.f,"20kHz" });
@@ -620,10 +1317,10 @@ EqualizerAudioProcessorEditor::EqualizerAudioProcessorEditor(EqualizerAudioProce
 	highCutFreqSlider.labels.add({ 1.f,"20kHz" });
 
 	lowCutSlopeSlider.labels.add({ 0.f, "12" });
-	lowCutSlopeSlider.labels.add({ 1.f, "48" });
+	lowCutSlopeSlider.labels.add({ 1.f, "96" });
 
 	highCutSlopeSlider.labels.add({ 0.f, "12" });
-	highCutSlopeSlider.labels.add({ 1.f, "48" });
+	highCutSlopeSlider.labels.add({ 1.f, "96" });
 
 
     for (auto* comp : getComps())
@@ -631,21 +1328,22 @@ EqualizerAudioProcessorEditor::EqualizerAudioProcessorEditor(EqualizerAudioProce
         addAndMakeVisible(comp);
     }
 
-	peakBypassButton.setLookAndFeel(&lnf);
+	bandBypassButton.setLookAndFeel(&lnf);
 	lowCutBypassButton.setLookAndFeel(&lnf);
 	highCutBypassButton.setLookAndFeel(&lnf);
 	analyzerEnabledButton.setLookAndFeel(&lnf);
 
 	auto safePtr = juce::Component::SafePointer<EqualizerAudioProcessorEditor>(this);
-	peakBypassButton.onClick = [safePtr]()
+	bandBypassButton.onClick = [safePtr]()
 		{
 			if (auto* comp = safePtr.getComponent())
 			{
-				auto bypassed = comp->peakBypassButton.getToggleState();
+				auto bypassed = comp->bandBypassButton.getToggleState();
 
-				comp->peakFreqSlider.setEnabled(!bypassed);
-				comp->peakGainSlider.setEnabled(!bypassed);
-				comp->peakQualitySlider.setEnabled(!bypassed);
+				comp->bandFreqSlider.setEnabled(!bypassed);
+				comp->bandGainSlider.setEnabled(!bypassed);
+				comp->bandQualitySlider.setEnabled(!bypassed);
+				comp->bandTypeBox.setEnabled(!bypassed);
 			}
 		};
 
@@ -671,6 +1369,26 @@ EqualizerAudioProcessorEditor::EqualizerAudioProcessorEditor(EqualizerAudioProce
 			}
 		};
 
+	// Analyzer settings, bound to the properties of the processor's analyzerSettings tree
+	auto& analyzerSettings = audioProcessor.analyzerSettings;
+
+	auto setUpAnalyzerBox = [&analyzerSettings](juce::ComboBox& box, const juce::StringArray& names, const juce::Identifier& property, int defaultId)
+		{
+			box.addItemList(names, 1);
+
+			if (!analyzerSettings.hasProperty(property))
+				analyzerSettings.setProperty(property, defaultId, nullptr);
+
+			box.getSelectedIdAsValue().referTo(analyzerSettings.getPropertyAsValue(property, nullptr));
+		};
+
+	setUpAnalyzerBox(analyzerModeBox, AnalyzerSettings::getModeNames(), "Mode", AnalyzerSettings::defaultModeId);
+	setUpAnalyzerBox(analyzerOverlapBox, AnalyzerSettings::getOverlapNames(), "Overlap", AnalyzerSettings::defaultOverlapId);
+	setUpAnalyzerBox(analyzerResolutionBox, AnalyzerSettings::getResolutionNames(), "Resolution", AnalyzerSettings::defaultResolutionId);
+	setUpAnalyzerBox(analyzerWindowBox, AnalyzerSettings::getWindowNames(), "Window", AnalyzerSettings::defaultWindowId);
+	setUpAnalyzerBox(analyzerAveragingBox, AnalyzerSettings::getAveragingNames(), "Averaging", AnalyzerSettings::defaultAveragingId);
+	setUpAnalyzerBox(analyzerDecayBox, AnalyzerSettings::getDecayRateNames(), "Decay", AnalyzerSettings::defaultDecayId);
+
 	analyzerEnabledButton.onClick = [safePtr]()
 		{
 			if (auto* comp = safePtr.getComponent())
@@ -680,12 +1398,152 @@ EqualizerAudioProcessorEditor::EqualizerAudioProcessorEditor(EqualizerAudioProce
 			}
 		};
 
-    setSize (600, 480);
+	// Parametric bands, one at a time in the middle column. They can also be picked on the response curve.
+	for (int band = 0; band < maxParametricBands; ++band)
+		bandSelectorBox.addItem("Band " + juce::String(band + 1), band + 1);
+
+	bandTypeBox.addItemList(audioProcessor.apvts.getParameter(getBandParameterID(0, "Type"))->getAllValueStrings(), 1);
+
+	bandSelectorBox.onChange = [safePtr]()
+		{
+			if (auto* comp = safePtr.getComponent())
+				comp->selectBand(comp->bandSelectorBox.getSelectedId() - 1);
+		};
+
+	responseCurveComponent.onBandClicked = [safePtr](int band)
+		{
+			if (auto* comp = safePtr.getComponent())
+				comp->selectBand(band);
+		};
+
+	responseCurveComponent.onAddBand = [safePtr](float freq, float gainInDecibels)
+		{
+			if (auto* comp = safePtr.getComponent())
+				comp->addBand(freq, gainInDecibels);
+		};
+
+	selectBand(0);
+
+	// Processing mode. The side parameters can only be edited while they're in use.
+	processingModeBox.addItemList(audioProcessor.apvts.getParameter("Processing Mode")->getAllValueStrings(), 1);
+	processingModeBoxAttachment = std::make_unique<APVTS::ComboBoxAttachment>(audioProcessor.apvts, "Processing Mode", processingModeBox);
+
+	processingModeBox.onChange = [safePtr]()
+		{
+			if (auto* comp = safePtr.getComponent())
+				comp->updateEditSideButton();
+		};
+
+	editSideButton.onClick = [safePtr]()
+		{
+			if (auto* comp = safePtr.getComponent())
+			{
+				comp->editedPrefix = comp->editSideButton.getToggleState() ? sideParameterPrefix : juce::String();
+				comp->selectBand(comp->selectedBand);
+			}
+		};
+
+	updateEditSideButton();
+
+    setSize (760, 505);
+}
+
+void EqualizerAudioProcessorEditor::attachChainControls()
+{
+	auto& apvts = audioProcessor.apvts;
+	const auto& parameterPrefix = editedPrefix;
+	const auto band = selectedBand;
+
+	// The old attachment has to let go of the control before the new one takes it over
+	auto attachSlider = [&apvts, &parameterPrefix](std::unique_ptr<Attachment>& attachment, RotarySliderWithLabels& slider, const juce::String& parameterName)
+		{
+			attachment.reset();
+			slider.setParameter(*apvts.getParameter(parameterPrefix + parameterName));
+			attachment = std::make_unique<Attachment>(apvts, parameterPrefix + parameterName, slider);
+		};
+
+	auto attachButton = [&apvts, &parameterPrefix](std::unique_ptr<ButtonAttachment>& attachment, juce::Button& button, const juce::String& parameterName)
+		{
+			attachment.reset();
+			attachment = std::make_unique<ButtonAttachment>(apvts, parameterPrefix + parameterName, button);
+		};
+
+	attachSlider(bandFreqSliderAttachment, bandFreqSlider, getBandParameterID(band, "Freq"));
+	attachSlider(bandGainSliderAttachment, bandGainSlider, getBandParameterID(band, "Gain"));
+	attachSlider(bandQualitySliderAttachment, bandQualitySlider, getBandParameterID(band, "Quality"));
+	attachSlider(lowCutFreqSliderAttachment, lowCutFreqSlider, "LowCut Freq");
+	attachSlider(highCutFreqSliderAttachment, highCutFreqSlider, "HighCut Freq");
+	attachSlider(lowCutSlopeSliderAttachment, lowCutSlopeSlider, "LowCut Slope");
+	attachSlider(highCutSlopeSliderAttachment, highCutSlopeSlider, "HighCut Slope");
+
+	attachButton(lowCutBypassButtonAttachment, lowCutBypassButton, "LowCut Bypassed");
+	attachButton(bandBypassButtonAttachment, bandBypassButton, getBandParameterID(band, "Bypassed"));
+	attachButton(highCutBypassButtonAttachment, highCutBypassButton, "HighCut Bypassed");
+
+	bandTypeBoxAttachment.reset();
+	bandTypeBoxAttachment = std::make_unique<APVTS::ComboBoxAttachment>(apvts, parameterPrefix + getBandParameterID(band, "Type"), bandTypeBox);
+
+	// The attachments set the toggle states without a click, so the sliders follow them here
+	for (auto* button : { &lowCutBypassButton, &bandBypassButton, &highCutBypassButton })
+		button->onClick();
+}
+
+void EqualizerAudioProcessorEditor::updateEditSideButton()
+{
+	const auto midSide = audioProcessor.getProcessingMode(audioProcessor.getTotalNumOutputChannels()) == MidSide;
+
+	editSideButton.setEnabled(midSide);
+
+	if (!midSide && editSideButton.getToggleState())
+	{
+		editSideButton.setToggleState(false, juce::dontSendNotification);
+		editedPrefix = {};
+		selectBand(selectedBand);
+	}
+}
+
+void EqualizerAudioProcessorEditor::selectBand(int band)
+{
+	selectedBand = juce::jlimit(0, maxParametricBands - 1, band);
+
+	bandSelectorBox.setSelectedId(selectedBand + 1, juce::dontSendNotification);
+	attachChainControls();
+
+	responseCurveComponent.setSelectedBand(editedPrefix, selectedBand);
+}
+
+void EqualizerAudioProcessorEditor::addBand(float freq, float gainInDecibels)
+{
+	// Takes the first bypassed band of the edited set, there's nothing to add once all of them are in use
+	const auto chainSettings = getChainSettings(audioProcessor.apvts, editedPrefix);
+
+	for (int band = 0; band < maxParametricBands; ++band)
+	{
+		if (!chainSettings.bands[(size_t)band].bypassed)
+			continue;
+
+		auto setValue = [this, band](const char* parameterName, float value)
+			{
+				auto* parameter = audioProcessor.apvts.getParameter(editedPrefix + getBandParameterID(band, parameterName));
+
+				parameter->beginChangeGesture();
+				parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+				parameter->endChangeGesture();
+			};
+
+		setValue("Type", (float)BandType::Bell);
+		setValue("Freq", freq);
+		setValue("Gain", gainInDecibels);
+		setValue("Bypassed", 0.f);
+
+		selectBand(band);
+		return;
+	}
 }
 
 EqualizerAudioProcessorEditor::~EqualizerAudioProcessorEditor()
 {
-	peakBypassButton.setLookAndFeel(nullptr);
+	bandBypassButton.setLookAndFeel(nullptr);
 	lowCutBypassButton.setLookAndFeel(nullptr);
 	highCutBypassButton.setLookAndFeel(nullptr);
 }
@@ -714,8 +1572,29 @@ void EqualizerAudioProcessorEditor::resized()
 
 	analyzerEnabledButton.setBounds(analyzerEnabledArea);
 
+	// Linear phase toggle, top right
+	auto linearPhaseArea = getLocalBounds().removeFromTop(25).removeFromRight(110);
+	linearPhaseArea.removeFromTop(2);
+
+	linearPhaseButton.setBounds(linearPhaseArea);
+
+	// Analyzer settings between the two
+	auto analyzerSettingsArea = getLocalBounds().removeFromTop(25).withTrimmedLeft(110).withTrimmedRight(115);
+	analyzerSettingsArea.removeFromTop(2);
+
+	const auto boxWidth = analyzerSettingsArea.getWidth() / 6;
+	for (auto* box : { &analyzerModeBox, &analyzerOverlapBox, &analyzerResolutionBox, &analyzerWindowBox, &analyzerAveragingBox, &analyzerDecayBox })
+		box->setBounds(analyzerSettingsArea.removeFromLeft(boxWidth).reduced(2, 0));
+
 	bounds.removeFromTop(5);
 
+	// Processing mode along the bottom
+	auto processingModeArea = bounds.removeFromBottom(25);
+	processingModeArea.removeFromBottom(2);
+
+	processingModeBox.setBounds(processingModeArea.removeFromLeft(130).reduced(5, 0));
+	editSideButton.setBounds(processingModeArea.removeFromLeft(100));
+
 	// Response curve area
 	float hRatio = 26.f / 100.f;
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * hRatio);
@@ -736,11 +1615,15 @@ void EqualizerAudioProcessorEditor::resized()
     highCutFreqSlider.setBounds(highCutArea.removeFromTop(highCutArea.getHeight() * 0.5));
     highCutSlopeSlider.setBounds(highCutArea);
 
-	//Peaks area
-	peakBypassButton.setBounds(bounds.removeFromTop(25));
-    peakFreqSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.33));
-    peakGainSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.5));
-    peakQualitySlider.setBounds(bounds);
+	// Parametric band area: bypass, band and type along the top
+	auto bandHeaderArea = bounds.removeFromTop(25);
+	bandBypassButton.setBounds(bandHeaderArea.removeFromLeft(25));
+	bandSelectorBox.setBounds(bandHeaderArea.removeFromLeft(bandHeaderArea.getWidth() / 2).reduced(2, 1));
+	bandTypeBox.setBounds(bandHeaderArea.reduced(2, 1));
+
+    bandFreqSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.33));
+    bandGainSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.5));
+    bandQualitySlider.setBounds(bounds);
 }
 
 //Returning components of GUI
@@ -748,9 +1631,9 @@ std::vector<juce::Component*> EqualizerAudioProcessorEditor::getComps()
 {
 	return
 	{
-		&peakFreqSlider,
-		&peakGainSlider,
-		&peakQualitySlider,
+		&bandFreqSlider,
+		&bandGainSlider,
+		&bandQualitySlider,
 		&lowCutFreqSlider,
 		&highCutFreqSlider,
 		&lowCutSlopeSlider,
@@ -758,8 +1641,20 @@ std::vector<juce::Component*> EqualizerAudioProcessorEditor::getComps()
 		&responseCurveComponent,
 
 		&lowCutBypassButton, 
-		&peakBypassButton, 
+		&bandBypassButton,
+		&bandSelectorBox,
+		&bandTypeBox, 
 		&highCutBypassButton, 
-		&analyzerEnabledButton
+		&analyzerEnabledButton,
+		&linearPhaseButton,
+		&editSideButton,
+
+		&processingModeBox,
+		&analyzerModeBox,
+		&analyzerOverlapBox,
+		&analyzerResolutionBox,
+		&analyzerWindowBox,
+		&analyzerAveragingBox,
+		&analyzerDecayBox
     };
 }
@@ -11,11 +11,136 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
 enum FFTOrder
 {
     order2048 = 11,
     order4096 = 12,
-    order8192 = 13
+    order8192 = 13,
+    order16384 = 14,
+    order32768 = 15
+};
+
+using WindowingMethod = juce::dsp::WindowingFunction<float>::WindowingMethod;
+
+// How the frames analysed during one update are turned into the displayed one
+enum class AnalyzerMode
+{
+    latestFrame,    // only the newest frame gets an FFT, the others are skipped
+    averageFrames   // every frame gets an FFT and the display shows their average (in dB)
+};
+
+enum class AnalyzerAveraging
+{
+    off,
+    exponential,    // follows each frame with a time constant of 6 dB / decay rate
+    peakHold        // jumps up to every peak, then falls at the decay rate
+};
+
+// Analyzer display settings. They live in EqualizerAudioProcessor::analyzerSettings as ComboBox ids
+// (1-based indexes into the tables below), so they're saved with the plugin state but can't be automated.
+struct AnalyzerSettings
+{
+    static constexpr std::array<AnalyzerMode, 2> modes{ AnalyzerMode::latestFrame, AnalyzerMode::averageFrames };
+    static constexpr std::array<float, 4> overlaps{ 0.f, 50.f, 75.f, 87.5f };                 // percent
+    static constexpr std::array<double, 6> resolutions{ 48.0, 24.0, 12.0, 6.0, 3.0, 1.5 };  // Hz
+    static constexpr std::array<float, 6> decayRates{ 3.f, 6.f, 12.f, 24.f, 48.f, 96.f };    // dB/s
+    static constexpr std::array<WindowingMethod, 6> windows{ WindowingMethod::rectangular,
+        WindowingMethod::hann,
+        WindowingMethod::hamming,
+        WindowingMethod::blackman,
+        WindowingMethod::blackmanHarris,
+        WindowingMethod::flatTop };
+
+    static juce::StringArray getModeNames();
+    static juce::StringArray getOverlapNames();
+    static juce::StringArray getResolutionNames();
+    static juce::StringArray getWindowNames();
+    static juce::StringArray getAveragingNames();
+    static juce::StringArray getDecayRateNames();
+
+    // Ids used when the state doesn't have a setting yet
+    static constexpr int defaultModeId = 1, defaultOverlapId = 3;
+    static constexpr int defaultResolutionId = 1, defaultWindowId = 5, defaultAveragingId = 1, defaultDecayId = 4;
+
+    AnalyzerMode mode = modes[defaultModeId - 1];
+    float overlap = overlaps[defaultOverlapId - 1];
+    double resolution = resolutions[defaultResolutionId - 1];
+    WindowingMethod window = windows[defaultWindowId - 1];
+    AnalyzerAveraging averaging = AnalyzerAveraging::off;
+    float decayRate = decayRates[defaultDecayId - 1];
+
+    static AnalyzerSettings fromValueTree(const juce::ValueTree& tree);
+};
+
+// Smallest FFT whose bandwidth per bin with 'window' is at most 'resolution' Hz,
+// or the largest available one if none is fine enough
+FFTOrder getAnalyzerOrderForResolution(double resolution, double sampleRate, WindowingMethod window);
+
+//==============================================================================
+// log2 from the float's exponent plus a degree 5 polynomial for the mantissa,
+// within 2e-5 of std::log2 (2e-4 dB) for every positive normal float
+inline float fastLog2(float x)
+{
+    juce::uint32 bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    const auto exponent = (float)((int)((bits >> 23) & 0xff) - 127);
+
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    const auto t = mantissa - 1.f;
+    const auto polynomial = t * (1.4418799f + t * (-0.70886522f + t * (0.41524556f + t * (-0.19351652f + t * 0.045268293f))));
+
+    return exponent + polynomial;
+}
+
+// Replaces FFT magnitudes by their level in decibels after scaling them, in one pass.
+// NaN and infinite magnitudes count as silence, anything below 'negativeInfinity' is clamped to it,
+// like juce::Decibels::gainToDecibels. There are no branches, so compilers can vectorise the loop.
+inline void convertMagnitudesToDecibels(float* data, int numBins, float scale, float negativeInfinity)
+{
+    constexpr auto decibelsPerOctave = 6.0205999f; // 20 * log10(2)
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto scaled = data[i] * scale;
+
+        // Masking the bits rather than selecting keeps the loop free of branches
+        juce::uint32 bits;
+        std::memcpy(&bits, &scaled, sizeof(bits));
+
+        const auto finiteMask = 0u - (juce::uint32)((bits & 0x7f800000u) != 0x7f800000u);
+        bits &= finiteMask;
+
+        float magnitude;
+        std::memcpy(&magnitude, &bits, sizeof(magnitude));
+
+        // Zero and denormals come out far below any sensible floor
+        const auto decibels = fastLog2(magnitude) * decibelsPerOctave;
+        data[i] = decibels > negativeInfinity ? decibels : negativeInfinity;
+    }
+}
+
+//==============================================================================
+// FFT plans and window tables shared by every analyzer in the process through a
+// juce::SharedResourcePointer. Each one is created when it's first asked for and freed
+// with its last user, so memory doesn't grow with the number of open editors.
+// Both are only ever read after creation, so any number of threads can use them at once.
+struct AnalyzerTables
+{
+    std::shared_ptr<const juce::dsp::FFT> getFFT(int order);
+    std::shared_ptr<const std::vector<float>> getWindow(int size, WindowingMethod method);
+
+private:
+    juce::CriticalSection lock;
+    std::map<int, std::weak_ptr<const juce::dsp::FFT>> ffts;
+    std::map<std::pair<int, WindowingMethod>, std::weak_ptr<const std::vector<float>>> windows;
 };
 
 template<typename BlockType>
@@ -28,54 +153,35 @@ struct FFTDataGenerator
     {
         const auto fftSize = getFFTSize();
 
-        fftData.assign(fftData.size(), 0);
+        // Only the first fftSize values are read by the transform, so the rest doesn't need clearing
         auto* readIndex = audioData.getReadPointer(0);
         std::copy(readIndex, readIndex + fftSize, fftData.begin());
 
         // first apply a windowing function to our data
-        window->multiplyWithWindowingTable(fftData.data(), fftSize);       // [1]
+        juce::FloatVectorOperations::multiply(fftData.data(), window->data(), fftSize);  // [1]
 
         // then render our FFT data..
         forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());  // [2]
 
         int numBins = (int)fftSize / 2;
 
-        //normalize the FFT values.
-        for (int i = 0; i < numBins; ++i)
-        {
-            auto v = fftData[i];
-            //            fftData[i] /= (float) numBins;
-            if (!std::isinf(v) && !std::isnan(v))
-            {
-                v /= float(numBins);
-            }
-            else
-            {
-                v = 0.f;
-            }
-            fftData[i] = v;
-        }
-
-        //convert them to decibels
-        for (int i = 0; i < numBins; ++i)
-        {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
-        }
+        // normalize the FFT values and convert them to decibels
+        convertMagnitudesToDecibels(fftData.data(), numBins, 1.f / float(numBins), negativeInfinity);
 
         fftDataFifo.push(fftData);
     }
 
-    void changeOrder(FFTOrder newOrder)
+    void changeOrder(FFTOrder newOrder, WindowingMethod windowingMethod = WindowingMethod::blackmanHarris)
     {
         //when you change order, recreate the window, forwardFFT, fifo, fftData
         //also reset the fifoIndex
-        //things that need recreating should be created on the heap via std::make_unique<>
+        //the FFT and the window table come from the tables shared by every analyzer in the process
 
         order = newOrder;
         auto fftSize = getFFTSize();
 
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+        forwardFFT = tables->getFFT(order);
+        window = tables->getWindow(fftSize, windowingMethod);
 
         fftData.clear();
         fftData.resize(fftSize * 2, 0);
@@ -91,78 +197,120 @@ struct FFTDataGenerator
 private:
     FFTOrder order;
     BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::shared_ptr<const juce::dsp::FFT> forwardFFT;
+    std::shared_ptr<const std::vector<float>> window;
+
+    juce::SharedResourcePointer<AnalyzerTables> tables;
 
     Fifo<BlockType> fftDataFifo;
 };
 //==============================================================================
 /**
 */
-template<typename PathType>
-struct AnalyzerPathGenerator
+//==============================================================================
+// How the bins falling onto one pixel column are combined
+enum class BinReduction
+{
+    maximum,    // peaks stay visible however many bins share a column
+    minimum,
+    mean
+};
+
+// Maps FFT bins onto the pixel columns of the analyzer's log frequency axis (20 Hz to 20 kHz).
+// Columns covering bins reduce them to one value, columns narrower than a bin (the low end)
+// interpolate between the bins around them, so the cost per frame is one pass over the bins
+// plus one value per column, without any logarithms.
+struct BinToPixelMap
+{
+    // Rebuilds the table if the width, FFT size or bin width changed. Returns true if it did.
+    bool update(int newWidth, int newFFTSize, float newBinWidth);
+
+    int getNumColumns() const { return (int)columns.size(); }
+
+    // 'bins' are the levels of the fftSize / 2 bins
+    float getColumnValue(const float* bins, int column, BinReduction reduction) const;
+
+private:
+    struct Column
+    {
+        int firstBin = 0, numBins = 0;  // no bins: interpolated at 'centreBin'
+        float centreBin = 0.f;          // fractional bin at the column's centre frequency
+    };
+
+    std::vector<Column> columns;
+    int fftSize = 0;
+    float binWidth = 0.f;
+};
+
+// One channel of the analyzer display: a y coordinate per pixel column, already in the
+// coordinates of the component. Fixed capacity, so copying it never allocates.
+struct AnalyzerTrace
+{
+    static constexpr int maxNumColumns = 4096;
+
+    // Rebuilds 'path' from the trace. Reusing the same path keeps its storage, so this doesn't allocate after the first call.
+    void toPath(juce::Path& path) const
+    {
+        path.clear();
+
+        if (numColumns == 0)
+            return;
+
+        path.preallocateSpace(3 * numColumns);
+        path.startNewSubPath(x, y[0]);
+
+        for (int column = 1; column < numColumns; ++column)
+            path.lineTo(x + (float)column, y[(size_t)column]);
+    }
+
+    std::array<float, maxNumColumns> y{};
+    int numColumns = 0;
+    float x = 0.f;  // x of the first column
+};
+
+struct AnalyzerTraceGenerator
 {
    
-     // Converts 'renderData[]' into a juce::Path
+     // Converts 'renderData[]' into 'trace', with one point per pixel column of 'fftBounds'
      
-    void generatePath(const std::vector<float>& renderData,
-                      juce::Rectangle<float> fftBounds,
-                      int fftSize,
-                      float binWidth,
-                      float negativeInfinity)
+    void generateTrace(const std::vector<float>& renderData,
+                       juce::Rectangle<float> fftBounds,
+                       int fftSize,
+                       float binWidth,
+                       float negativeInfinity,
+                       AnalyzerTrace& trace,
+                       BinReduction reduction = BinReduction::maximum)
     {
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
-
-        int numBins = (int)fftSize / 2;
 
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        binToPixelMap.update(juce::jmin((int)fftBounds.getWidth(), AnalyzerTrace::maxNumColumns), fftSize, binWidth);
+        const auto numColumns = binToPixelMap.getNumColumns();
 
+        // The translation into the component is added here rather than applied to a path when painting
         auto map = [bottom, top, negativeInfinity](float v)
         {
                 return juce::jmap(v,
                                   negativeInfinity, 0.f,
-                                  float(bottom + 10), top);
+                                  float(bottom + 10), top) + top;
         };
 
-        auto y = map(renderData[0]);
-
-        if (std::isnan(y) || std::isinf(y))
-            y = bottom;
-
-        p.startNewSubPath(0, y);
+        for (int x = 0; x < numColumns; ++x)
+        {
+            auto y = map(binToPixelMap.getColumnValue(renderData.data(), x, reduction));
 
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+            if (std::isnan(y) || std::isinf(y))
+                y = bottom + top;
 
-        for (int binNum = 1; binNum < numBins; binNum += pathResolution)
-        {
-            y = map(renderData[binNum]);
-
-            if (!std::isnan(y) && !std::isinf(y))
-            {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
-            }
+            trace.y[(size_t)x] = y;
         }
 
-        pathFifo.push(p);
-    }
-
-    int getNumPathsAvailable() const
-    {
-        return pathFifo.getNumAvailableForReading();
+        trace.numColumns = numColumns;
+        trace.x = fftBounds.getX();
     }
 
-    bool getPath(PathType& path)
-    {
-        return pathFifo.pull(path);
-    }
 private:
-    Fifo<PathType> pathFifo;
+    BinToPixelMap binToPixelMap;
 };
 //==============================================================================
 /**
@@ -213,6 +361,13 @@ struct RotarySliderWithLabels : juce::Slider
     juce::Rectangle<int> getSliderBounds() const;
     int getTextHeight() const { return 14; }
     juce::String getDisplayString() const;
+
+    // When the slider gets attached to another parameter with the same range
+    void setParameter(juce::RangedAudioParameter& rap)
+    {
+        param = &rap;
+        repaint();
+    }
 private:
     LookAndFeel lnf;
 
@@ -225,30 +380,269 @@ struct PathProducer
     PathProducer(SingleChannelSampleFifo<EqualizerAudioProcessor::BlockType>& scsf) :
     leftChannelFifo(&scsf)
     {
-		leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-		monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        configure(FFTOrder::order2048, WindowingMethod::blackmanHarris);
+    }
+
+    // Returns true if a new trace was generated
+    bool process(juce::Rectangle<float> fftBounds, double sampleRate);
+
+    const AnalyzerTrace& getTrace() const { return trace; }
+
+    // Rebuilds the FFT and window if either changed. This allocates, so it's called on the
+    // analyzer thread between two updates, which keeps the message thread out of it.
+    void configure(FFTOrder order, WindowingMethod window);
+
+    // Samples between two analysis frames, independent of the host's buffer size.
+    // The analyzer runs sampleRate / hopSize frames per second.
+    void setHopSize(int newHopSize) { hopSize = juce::jlimit(1, monoBuffer.getNumSamples(), newHopSize); }
+    int getHopSize() const { return hopSize; }
+
+    // Overlap of consecutive frames in percent of the FFT size, e.g. 75 gives a hop of a quarter FFT.
+    // Large FFTs can need more overlap than that to keep the hop below 'maxHopSize'.
+    void setOverlap(float percent, int maxHopSize = std::numeric_limits<int>::max())
+    {
+        overlapPercent = juce::jlimit(0.f, 95.f, percent);
+        setHopSize(juce::jmin(maxHopSize, juce::roundToInt(monoBuffer.getNumSamples() * (1.f - overlapPercent / 100.f))));
     }
 
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
+    void setMode(AnalyzerMode newMode) { mode = newMode; }
+
+    void setAveraging(AnalyzerAveraging newAveraging, float newDecayRate)
+    {
+        if (newAveraging != averaging)
+        {
+            displayNeedsReset = true;
+            displayIsSettled = false;
+        }
 
-    juce::Path getPath() { return leftChannelFFTPath; }
+        averaging = newAveraging;
+        decayRate = newDecayRate;
+    }
 private:
+    void applyAveraging(const std::vector<float>& frame, double secondsSinceLastFrame);
+
     SingleChannelSampleFifo<EqualizerAudioProcessor::BlockType>* leftChannelFifo;
 
     juce::AudioBuffer<float> monoBuffer;
+    int hopSize = 0;
+    float overlapPercent = 75.f;
+    AnalyzerMode mode = AnalyzerMode::latestFrame;
+
+    FFTOrder currentOrder{};
+    WindowingMethod currentWindow{};
+
+    AnalyzerAveraging averaging = AnalyzerAveraging::off;
+    float decayRate = 24.f;
+    bool displayNeedsReset = true;
+    int hopsSinceLastFrame = 0;
+
+    // Once the input has been silent for a whole window and the display has decayed to the floor,
+    // every further frame would look the same, so they're skipped until the input comes back
+    static constexpr float floorDecibels = -48.f;
+    static constexpr float silenceThreshold = 1.0e-5f; // -100 dBFS
+    int numSilentSamples = 0;
+    bool displayIsSettled = false;
+    juce::Rectangle<float> lastBounds;
+
+    bool isDisplayAtFloor() const;
 
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    std::vector<float> fftData, averagedFFTData, displayData;
 
-    AnalyzerPathGenerator<juce::Path> pathProducer;
+    AnalyzerTraceGenerator traceGenerator;
+    AnalyzerTrace trace;
+};
+//==============================================================================
+// One timer driving the displays of every editor in the process, instead of one per instance.
+// Owned through a juce::SharedResourcePointer, so it exists while at least one editor does.
+// The frame rate limit is global and kept in the user's settings file.
+struct FrameDriver : private juce::Timer
+{
+    struct Client
+    {
+        virtual ~Client() = default;
 
-    juce::Path leftChannelFFTPath;
+        // Message thread, once per frame
+        virtual void frameCallback() = 0;
+    };
+
+    FrameDriver();
+    ~FrameDriver() override;
+
+    void addClient(Client* client);
+    void removeClient(Client* client);
+
+    static constexpr std::array<int, 4> frameRates{ 15, 30, 60, 120 };
+    static constexpr int defaultFrameRate = 60;
+
+    void setMaximumFrameRate(int framesPerSecond);
+    int getMaximumFrameRate() const { return maximumFrameRate; }
+
+private:
+    void timerCallback() override;
+
+    juce::ListenerList<Client> clients;
+    juce::PropertiesFile settings;
+    int maximumFrameRate = defaultFrameRate;
+};
+
+struct AnalyzerJob;
+
+//==============================================================================
+// Process-wide scheduler for the analysis of every open editor, through a juce::SharedResourcePointer.
+// A few worker threads (at most half the cores, at most 4) take due jobs round robin, so every
+// editor gets its turn however many are open, and one job never runs on two workers at once.
+struct AnalyzerService
+{
+    AnalyzerService();
+    ~AnalyzerService();
+
+    void addJob(AnalyzerJob* job);
+
+    // Waits for the job to finish if a worker is running it
+    void removeJob(AnalyzerJob* job);
+
+private:
+    struct Worker : juce::Thread
+    {
+        Worker(AnalyzerService& owner) : juce::Thread("Analyzer"), service(owner) {}
+
+        void run() override;
+
+        AnalyzerService& service;
+    };
+
+    struct ScheduledJob
+    {
+        AnalyzerJob* job = nullptr;
+        juce::uint32 lastRunMs = 0;
+        bool isRunning = false;
+    };
+
+    // Blocks until a job is due or the worker should exit. Returns nullptr in the latter case.
+    AnalyzerJob* takeNextJob(Worker& worker);
+    void finishJob(AnalyzerJob* job);
+
+    // Longest a worker sleeps without looking for new jobs
+    static constexpr int maxWaitMs = 50;
+
+    std::mutex mutex;
+    std::condition_variable jobsChanged;
+
+    std::vector<ScheduledJob> jobs;
+    size_t nextJob = 0;
+
+    juce::OwnedArray<Worker> workers;
+};
+
+//==============================================================================
+// Runs both channels' PathProducers of one editor on the AnalyzerService's workers
+// and hands the finished traces over to the GUI through a TripleBuffer
+struct AnalyzerJob
+{
+    struct Traces
+    {
+        AnalyzerTrace left, right;
+    };
+
+    AnalyzerJob(EqualizerAudioProcessor&);
+    ~AnalyzerJob();
+
+    // Message thread
+    void setAnalysisBounds(juce::Rectangle<float> bounds)
+    {
+        boundsBuffer.getWriteBuffer() = bounds;
+        boundsBuffer.publish();
+    }
+
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled); }
+    void setSettings(const AnalyzerSettings& settings);
+    void setMaximumFrameRate(int framesPerSecond) { analysisIntervalMs.store(juce::jmax(1, 1000 / framesPerSecond)); }
+
+    bool pull() { return traceBuffer.pull(); }
+    const Traces& getLatest() const { return traceBuffer.getReadBuffer(); }
+
+    // Called by the service's workers, never by two at once
+    void run();
+
+    // Whether the job wants to run, and how long it waits between two runs
+    bool isEnabled() const { return enabled.load(); }
+    int getIntervalMs() const { return analysisIntervalMs.load(); }
+
+private:
+    std::atomic<int> analysisIntervalMs{ 1000 / FrameDriver::defaultFrameRate };
+
+    // Large FFTs still produce at least this many frames per second
+    static constexpr double minFramesPerSecond = 30.0;
+
+    void applySettings(double sampleRate);
+
+    EqualizerAudioProcessor& audioProcessor;
+    PathProducer leftPathProducer, rightPathProducer;
+
+    // A Rectangle<float> is too big for std::atomic to be lock-free, so it's handed over like the traces
+    TripleBuffer<juce::Rectangle<float>> boundsBuffer;
+
+    std::atomic<bool> enabled{ true };
+    std::atomic<AnalyzerMode> mode{ AnalyzerSettings().mode };
+    std::atomic<float> overlap{ AnalyzerSettings().overlap };
+
+    std::atomic<double> resolution{ AnalyzerSettings().resolution };
+    std::atomic<WindowingMethod> window{ AnalyzerSettings().window };
+    std::atomic<AnalyzerAveraging> averaging{ AnalyzerSettings().averaging };
+    std::atomic<float> decayRate{ AnalyzerSettings().decayRate };
+
+    TripleBuffer<Traces> traceBuffer;
+
+    juce::SharedResourcePointer<AnalyzerService> service;
 };
+
+//==============================================================================
+// Paint times of the last second of frames, for checking the cost of the editor.
+// Set EQUALIZER_SHOW_FRAME_TIME=1 in the preprocessor definitions to show them in the analyzer.
+#ifndef EQUALIZER_SHOW_FRAME_TIME
+ #define EQUALIZER_SHOW_FRAME_TIME 0
+#endif
+
+struct FrameTimeCounter
+{
+    void addFrame(double seconds)
+    {
+        frameSeconds[(size_t)nextFrame] = seconds;
+        nextFrame = (nextFrame + 1) % numFrames;
+        numRecorded = juce::jmin(numRecorded + 1, numFrames);
+    }
+
+    double getAverageMilliseconds() const
+    {
+        if (numRecorded == 0)
+            return 0.0;
+
+        return 1.0e3 * std::accumulate(frameSeconds.begin(), frameSeconds.begin() + numRecorded, 0.0) / numRecorded;
+    }
+
+    double getMaxMilliseconds() const
+    {
+        if (numRecorded == 0)
+            return 0.0;
+
+        return 1.0e3 * *std::max_element(frameSeconds.begin(), frameSeconds.begin() + numRecorded);
+    }
+
+private:
+    static constexpr int numFrames = 60;
+
+    std::array<double, numFrames> frameSeconds{};
+    int nextFrame = 0, numRecorded = 0;
+};
+
 //==============================================================================
 /**
 */
 struct ResponseCurveComponent : juce::Component,
     juce::AudioProcessorParameter::Listener,
-    juce::Timer
+    juce::ValueTree::Listener,
+    FrameDriver::Client
 {
     ResponseCurveComponent(EqualizerAudioProcessor&);
     ~ResponseCurveComponent();
@@ -257,7 +651,22 @@ struct ResponseCurveComponent : juce::Component,
 
 	void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override {};
 
-	void timerCallback() override;
+	// Analyzer settings changed in the processor's analyzerSettings tree
+	void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+
+	void frameCallback() override;
+
+	// Click a band's marker to select it, right click for the frame rate limit
+	void mouseDown(const juce::MouseEvent& event) override;
+
+	// Double click to switch on a band where the pointer is
+	void mouseDoubleClick(const juce::MouseEvent& event) override;
+
+	// Marks the band the editor's controls are attached to, in the parameter set with 'parameterPrefix'
+	void setSelectedBand(const juce::String& parameterPrefix, int band);
+
+	std::function<void(int band)> onBandClicked;
+	std::function<void(float freq, float gainInDecibels)> onAddBand;
 
     void paint(juce::Graphics& g) override;
     void resized() override;
@@ -265,22 +674,62 @@ struct ResponseCurveComponent : juce::Component,
     void toggleAnalysisEnablement(bool enabled)
     {
         shouldShowFFTAnalysis = enabled;
+        analyzer.setEnabled(enabled && isShowing());
+        repaint(getAnalysisArea());
     };
 private:
     EqualizerAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged{ false };
 
-    MonoChain monoChain;
+    ChainCoefficients chainCoefficients;
+
+    // Only shown in Mid/Side mode, next to the main curve
+    ChainCoefficients sideChainCoefficients;
+    bool showsSideCurve = false;
 
     void updateChain();
 
-    juce::Image background;
+    // Cached curves, see updateResponseCurve()
+    juce::Path responseCurve, sideResponseCurve;
+
+    // One marker per active band of the edited parameter set, drawn with the curves
+    juce::String markedPrefix;
+    int selectedBand = 0;
+
+    const ChainSettings& getMarkedSettings() const;
+    juce::Point<float> getBandMarkerPosition(const BandSettings& bandSettings);
+    std::vector<double> mags;
+    ChainMagnitudeEvaluator magnitudeEvaluator;
+    double curveSampleRate = 0.0;
+
+    void updateResponseCurve();
+
+    // Cached layers at the display's physical resolution: the grid and labels only change with the
+    // size or the scale, the border and response curve with the parameters. The analyzer is drawn between them.
+    juce::Image staticLayer, curveLayer;
+    float layerScale = 1.f;
+    bool curveLayerNeedsUpdate = true;
+
+    void renderStaticLayer();
+    void renderCurveLayer();
+
+    FrameTimeCounter frameTimeCounter;
 
     juce::Rectangle<int> getRenderArea();
 
     juce::Rectangle<int> getAnalysisArea();
 
-    PathProducer leftPathProducer, rightPathProducer;
+    // Only shows anything once the GUI couldn't keep up with the audio thread's taps
+    void drawAnalyzerOverruns(juce::Graphics& g);
+    int getNumAnalyzerOverruns() const;
+    int lastNumAnalyzerOverruns = 0;
+
+    AnalyzerJob analyzer;
+
+    juce::SharedResourcePointer<FrameDriver> frameDriver;
+
+    // Rebuilt from the analyzer's traces in every paint, reusing its storage
+    juce::Path analyzerPath;
 
     bool shouldShowFFTAnalysis = true;
 };
@@ -324,9 +773,9 @@ private:
     // access the processor object that created it.
     EqualizerAudioProcessor& audioProcessor;
 
-    RotarySliderWithLabels peakFreqSlider,
-        peakGainSlider,
-        peakQualitySlider,
+    RotarySliderWithLabels bandFreqSlider,
+        bandGainSlider,
+        bandQualitySlider,
         lowCutFreqSlider,
         highCutFreqSlider,
         lowCutSlopeSlider,
@@ -337,23 +786,51 @@ private:
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
 
-	Attachment peakFreqSliderAttachment,
-		peakGainSliderAttachment,
-		peakQualitySliderAttachment,
+    // Recreated when the controls switch to another band, or between the main and the "Side ..." parameters
+	std::unique_ptr<Attachment> bandFreqSliderAttachment,
+		bandGainSliderAttachment,
+		bandQualitySliderAttachment,
 		lowCutFreqSliderAttachment,
 		highCutFreqSliderAttachment,
 		lowCutSlopeSliderAttachment,
 		highCutSlopeSliderAttachment;
 
-    PowerButton lowCutBypassButton, peakBypassButton, highCutBypassButton;
+    PowerButton lowCutBypassButton, bandBypassButton, highCutBypassButton;
     AnalyzerButton analyzerEnabledButton;
+    juce::ToggleButton linearPhaseButton{ "Linear Phase" };
+
+    // Processing mode, and in Mid/Side mode whether the controls edit mid or side
+    juce::ComboBox processingModeBox;
+    juce::ToggleButton editSideButton{ "Edit Side" };
+
+    // The parametric band the middle column edits
+    juce::ComboBox bandSelectorBox, bandTypeBox;
+
+    juce::String editedPrefix;
+    int selectedBand = 0;
+
+    void attachChainControls();
+    void selectBand(int band);
+    void addBand(float freq, float gainInDecibels);
+    void updateEditSideButton();
+
+    // Bound to the processor's analyzerSettings, they aren't parameters
+    juce::ComboBox analyzerModeBox, analyzerOverlapBox;
+    juce::ComboBox analyzerResolutionBox, analyzerWindowBox, analyzerAveragingBox, analyzerDecayBox;
 
     using ButtonAttachment = APVTS::ButtonAttachment;
 
-    ButtonAttachment lowCutBypassButtonAttachment,
-                     peakBypassButtonAttachment,
-                     highCutBypassButtonAttachment,
-                     analyzerEnabledButtonAttachment;
+    std::unique_ptr<ButtonAttachment> lowCutBypassButtonAttachment,
+                                      bandBypassButtonAttachment,
+                                      highCutBypassButtonAttachment;
+
+    std::unique_ptr<APVTS::ComboBoxAttachment> bandTypeBoxAttachment;
+
+    ButtonAttachment analyzerEnabledButtonAttachment,
+                     linearPhaseButtonAttachment;
+
+    // Created once the box has its items
+    std::unique_ptr<APVTS::ComboBoxAttachment> processingModeBoxAttachment;
 
     std::vector<juce::Component*> getComps();
 
@@ -22,10 +22,15 @@ EqualizerAudioProcessor::EqualizerAudioProcessor()
                        )
 #endif
 {
+    smoothingParameter = apvts.getRawParameterValue("Smoothing");
+    linearPhaseParameter = apvts.getRawParameterValue("Linear Phase");
+    processingModeParameter = apvts.getRawParameterValue("Processing Mode");
 }
 
 EqualizerAudioProcessor::~EqualizerAudioProcessor()
 {
+    coefficientDesigner.release();
+    sideCoefficientDesigner.release();
 }
 
 //==============================================================================
@@ -63,7 +68,11 @@ bool EqualizerAudioProcessor::isMidiEffect() const
 
 double EqualizerAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The IIR filters decay quickly enough to report none, an FIR kernel rings for its whole length
+    if (!isLinearPhaseEnabled() || getSampleRate() <= 0.0)
+        return 0.0;
+
+    return getLinearPhaseKernelLength(getSampleRate()) / getSampleRate();
 }
 
 int EqualizerAudioProcessor::getNumPrograms()
@@ -104,13 +113,62 @@ void EqualizerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlo
 
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    const auto numGroups = juce::jmax(1, (getTotalNumOutputChannels() + (int)SIMDSample::size() - 1) / (int)SIMDSample::size());
+
+    channelGroupChains.clear();
+
+    for (int i = 0; i < numGroups; ++i)
+    {
+        auto* chain = channelGroupChains.add(new SIMDChain());
+        chain->prepare(spec);
+    }
+
+    midSideChain = std::make_unique<SIMDChain>();
+    midSideChain->prepare(spec);
+
+    interleavedBlock = juce::dsp::AudioBlock<SIMDSample>(interleavedBlockData, 1, (size_t)samplesPerBlock);
+    interleavedBlock.clear();
+
+    activeProcessingMode = getProcessingMode(getTotalNumOutputChannels());
+
+    // The initial sets are applied from the smoothers, which outlive this function
+    smoother.reset(sampleRate, smoothingTimeSeconds);
+    smoother.getCoefficients() = coefficientDesigner.prepare(sampleRate);
+    smoother.setTargets(smoother.getCoefficients().settings, true);
+
+    sideSmoother.reset(sampleRate, smoothingTimeSeconds);
+    sideSmoother.getCoefficients() = sideCoefficientDesigner.prepare(sampleRate);
+    sideSmoother.setTargets(sideSmoother.getCoefficients().settings, true);
 
-    updateFilters();
+    mainCoefficients = sideCoefficients = nullptr;
+    updateFilters(smoother.getCoefficients());
+    updateSideFilters(sideSmoother.getCoefficients());
 
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    const auto numPartitions = getLinearPhaseKernelLength(sampleRate) / linearPhasePartitionSize;
+
+    convolutionFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * linearPhasePartitionSize)));
+    convolvers.clear();
+
+    for (int channel = 0; channel < getTotalNumOutputChannels(); ++channel)
+        convolvers.add(new PartitionedConvolver())->prepare(linearPhasePartitionSize, numPartitions);
+
+    // Swapped with the designers' slots, which then get overwritten in place
+    previousKernel.prepare(linearPhasePartitionSize, numPartitions);
+    previousSideKernel.prepare(linearPhasePartitionSize, numPartitions);
+
+    const auto linearPhaseLatency = getLinearPhaseLatencySamples(sampleRate);
+
+    // The host isn't playing yet, so the latency can be reported right away
+    cancelPendingUpdate();
+    linearPhaseActive = isLinearPhaseEnabled();
+    setLatencySamples(linearPhaseActive ? linearPhaseLatency : 0);
+
+    linearPhaseDelay.setMaximumDelayInSamples(linearPhaseLatency);
+    linearPhaseDelay.prepare({ sampleRate, (juce::uint32)samplesPerBlock, 2 });
+    linearPhaseDelay.setDelay((float)linearPhaseLatency);
+
+    leftChannelFifo.prepare();
+    rightChannelFifo.prepare();
 
     osc.initialise([](float x) { return std::sin(x); });
 
@@ -123,6 +181,8 @@ void EqualizerAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    coefficientDesigner.release();
+    sideCoefficientDesigner.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -132,12 +192,11 @@ bool EqualizerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel goes through the same filters, so any discrete or ambisonic
+    // layout works as long as it isn't disabled and doesn't exceed maxNumChannels.
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numChannels == 0 || numChannels > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -151,6 +210,55 @@ bool EqualizerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 }
 #endif
 
+// Mid and side are scaled by one half, so decoding is a plain sum and difference.
+// One fused pass over both channels, which compilers vectorise as the pointers can't alias.
+static void encodeMidSide(float* __restrict left, float* __restrict right, int numSamples)
+{
+	for (int i = 0; i < numSamples; ++i)
+	{
+		const auto l = left[i], r = right[i];
+		left[i] = 0.5f * (l + r);
+		right[i] = 0.5f * (l - r);
+	}
+}
+
+static void decodeMidSide(float* __restrict mid, float* __restrict side, int numSamples)
+{
+	for (int i = 0; i < numSamples; ++i)
+	{
+		const auto m = mid[i], s = side[i];
+		mid[i] = m + s;
+		side[i] = m - s;
+	}
+}
+
+template<typename UpdateFunction>
+void EqualizerAudioProcessor::pullCoefficients(CoefficientDesigner& designer, ChainSmoother& chainSmoother, int subBlockSize, UpdateFunction&& updateChains)
+{
+    if (designer.pull())
+    {
+        const auto& latest = designer.getLatest();
+        chainSmoother.setTargets(latest.settings, subBlockSize == 0);
+
+        if (subBlockSize == 0)
+        {
+            updateChains(latest);
+        }
+        else
+        {
+            chainSmoother.getCoefficients() = latest;
+            chainSmoother.update(0, getSampleRate());
+            updateChains(chainSmoother.getCoefficients());
+        }
+    }
+    else if (subBlockSize == 0 && chainSmoother.getSmoothingBands() != 0)
+    {
+        // Smoothing was switched off halfway through a ramp
+        chainSmoother.setTargets(chainSmoother.getTargets(), true);
+        updateChains(designer.getLatest());
+    }
+}
+
 void EqualizerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
@@ -166,29 +274,360 @@ void EqualizerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // Stereo input processing
-    updateFilters();
+    // Coefficients are designed on the CoefficientDesigner threads, here we only pick up the latest sets.
+    // The side set is followed in every mode, so switching to Mid/Side needs no redesign.
+    auto subBlockSize = getSmoothingSubBlockSize();
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    // A channel's filter state belongs to whatever signal it filtered before, which changes with the mode
+    if (const auto mode = getProcessingMode(buffer.getNumChannels()); mode != activeProcessingMode)
+    {
+        activeProcessingMode = mode;
 
-	// Testing the spectrum analyzer
-   /* buffer.clear();
+        for (auto* chain : channelGroupChains)
+            chain->reset();
 
-    juce::dsp::ProcessContextReplacing<float> stereoContext(block);
-    osc.process(stereoContext);*/
+        midSideChain->reset();
+        updateMidSideChain();
 
-   
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+        for (auto* convolver : convolvers)
+            convolver->reset();
+
+        linearPhaseDelay.reset();
+    }
+
+    pullCoefficients(coefficientDesigner, smoother, subBlockSize, [this](const ChainCoefficients& c) { updateFilters(c); });
+    pullCoefficients(sideCoefficientDesigner, sideSmoother, subBlockSize, [this](const ChainCoefficients& c) { updateSideFilters(c); });
+
+    // Only the mode that was idle needs its state cleared. Switching to linear phase waits for
+    // kernels designed after the switch, meanwhile the IIR chains keep running.
+    if (const auto linearPhase = isLinearPhaseEnabled(); linearPhase != linearPhaseActive && (!linearPhase || areLinearPhaseKernelsReady()))
+    {
+        linearPhaseActive = linearPhase;
+
+        // Hosts expect latency changes on the message thread
+        pendingLatencySamples.store(linearPhaseActive ? getLinearPhaseLatencySamples(getSampleRate()) : 0);
+        triggerAsyncUpdate();
+
+        if (linearPhaseActive)
+        {
+            for (auto* convolver : convolvers)
+                convolver->reset();
+
+            linearPhaseDelay.reset();
+        }
+        else
+        {
+            for (auto* chain : channelGroupChains)
+                chain->reset();
+
+            midSideChain->reset();
+        }
+    }
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    const auto midSide = usesMidSide(activeProcessingMode);
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if (midSide)
+        encodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
 
+    if (linearPhaseActive)
+    {
+        processLinearPhase(buffer);
+    }
+    else
+    {
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        // Testing the spectrum analyzer
+       /* buffer.clear();
+
+        juce::dsp::ProcessContextReplacing<float> stereoContext(block);
+        osc.process(stereoContext);*/
+
+        const auto sideBands = activeProcessingMode == MidSide ? sideSmoother.getSmoothingBands() : 0;
+
+        if (subBlockSize == 0 || (smoother.getSmoothingBands() | sideBands) == 0)
+        {
+            processChains(block);
+        }
+        else
+        {
+            const auto numSamples = block.getNumSamples();
+
+            for (size_t start = 0; start < numSamples; start += (size_t)subBlockSize)
+            {
+                auto subBlockLength = juce::jmin((size_t)subBlockSize, numSamples - start);
+
+                smoother.update((int)subBlockLength, getSampleRate());
+                updateFilters(smoother.getCoefficients());
+
+                if (sideBands != 0)
+                {
+                    sideSmoother.update((int)subBlockLength, getSampleRate());
+                    updateSideFilters(sideSmoother.getCoefficients());
+                }
+
+                processChains(block.getSubBlock(start, subBlockLength));
+            }
+        }
+    }
+
+    // Tapped before decoding, so in the mid/side modes the analyzer shows mid and side
     leftChannelFifo.update(buffer);
     rightChannelFifo.update(buffer);
+
+    if (midSide)
+        decodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
+}
+
+void EqualizerAudioProcessor::pullLinearPhaseKernels()
+{
+    // The kernel a convolver fades out of has to stay where it is until its next partition
+    for (auto* convolver : convolvers)
+        if (convolver->isCrossfading())
+            return;
+
+    const auto mainKernelChanged = coefficientDesigner.pullKernel(previousKernel);
+    const auto sideKernelChanged = sideCoefficientDesigner.pullKernel(previousSideKernel);
+
+    for (int channel = 0; channel < convolvers.size(); ++channel)
+    {
+        const auto role = getChannelRole(channel);
+
+        if (role == ChannelRole::main && mainKernelChanged)
+            convolvers.getUnchecked(channel)->crossfadeFrom(previousKernel);
+        else if (role == ChannelRole::side && sideKernelChanged)
+            convolvers.getUnchecked(channel)->crossfadeFrom(previousSideKernel);
+    }
+}
+
+bool EqualizerAudioProcessor::areLinearPhaseKernelsReady()
+{
+    // The convolvers are idle and get reset when the mode switches, so there's nothing to crossfade
+    coefficientDesigner.pullKernel(previousKernel);
+    sideCoefficientDesigner.pullKernel(previousSideKernel);
+
+    return coefficientDesigner.isKernelUpToDate() && sideCoefficientDesigner.isKernelUpToDate();
+}
+
+void EqualizerAudioProcessor::processLinearPhase(juce::AudioBuffer<float>& buffer)
+{
+    // Kernels are designed on the CoefficientDesigner threads. A new one takes over at each
+    // convolver's next partition boundary, crossfading from the previous one over that partition.
+    pullLinearPhaseKernels();
+
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), convolvers.size());
+    const auto numSamples = buffer.getNumSamples();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = buffer.getWritePointer(channel);
+
+        switch (getChannelRole(channel))
+        {
+        case ChannelRole::main:
+            convolvers.getUnchecked(channel)->process(samples, numSamples, coefficientDesigner.getLatestKernel(), *convolutionFFT);
+            break;
+
+        case ChannelRole::side:
+            convolvers.getUnchecked(channel)->process(samples, numSamples, sideCoefficientDesigner.getLatestKernel(), *convolutionFFT);
+            break;
+
+        case ChannelRole::bypassed:
+            // A plain delay instead of a convolution with one, to keep the latency the same on both channels
+            for (int i = 0; i < numSamples; ++i)
+            {
+                linearPhaseDelay.pushSample(channel, samples[i]);
+                samples[i] = linearPhaseDelay.popSample(channel);
+            }
+            break;
+        }
+    }
+}
+
+void EqualizerAudioProcessor::processChains(const juce::dsp::AudioBlock<float>& block)
+{
+    // Mid and side go through one pass like the two channels of Stereo mode, in lanes with their own coefficients
+    if (activeProcessingMode == MidSide)
+    {
+        processChannelGroup(*midSideChain, block);
+        return;
+    }
+
+    // The single channel modes only filter one channel, with the first group's chain
+    if (activeProcessingMode != Stereo)
+    {
+        for (size_t channel = 0; channel < 2; ++channel)
+            if (getChannelRole((int)channel) == ChannelRole::main)
+                processChannelGroup(*channelGroupChains.getFirst(), block.getSingleChannelBlock(channel));
+
+        return;
+    }
+
+    constexpr auto numLanes = SIMDSample::size();
+
+    for (size_t group = 0; group < (size_t)channelGroupChains.size(); ++group)
+    {
+        const auto firstChannel = group * numLanes;
+
+        if (firstChannel >= block.getNumChannels())
+            break;
+
+        const auto numChannels = juce::jmin(numLanes, block.getNumChannels() - firstChannel);
+        processChannelGroup(*channelGroupChains.getUnchecked((int)group), block.getSubsetChannelBlock(firstChannel, numChannels));
+    }
+}
+
+void EqualizerAudioProcessor::processChannelGroup(SIMDChain& chain, const juce::dsp::AudioBlock<float>& block)
+{
+    // Instead of running one chain per channel, the channels are interleaved into the lanes
+    // of a SIMDSample and filtered in a single pass
+    constexpr auto numLanes = SIMDSample::size();
+    const auto numChannels = block.getNumChannels();
+    const auto maxSamples = interleavedBlock.getNumSamples();
+
+    jassert(numChannels <= numLanes);
+
+    auto* interleaved = reinterpret_cast<float*>(interleavedBlock.getChannelPointer(0));
+
+    for (size_t start = 0; start < block.getNumSamples(); start += maxSamples)
+    {
+        const auto numSamples = juce::jmin(maxSamples, block.getNumSamples() - start);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* source = block.getChannelPointer(channel) + start;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                interleaved[i * numLanes + channel] = source[i];
+        }
+
+        // Lanes without a channel would otherwise still hold the previous group's samples
+        for (size_t channel = numChannels; channel < numLanes; ++channel)
+            for (size_t i = 0; i < numSamples; ++i)
+                interleaved[i * numLanes + channel] = 0.f;
+
+        auto subBlock = interleavedBlock.getSubBlock(0, numSamples);
+        juce::dsp::ProcessContextReplacing<SIMDSample> context(subBlock);
+        chain.process(context);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* destination = block.getChannelPointer(channel) + start;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                destination[i] = interleaved[i * numLanes + channel];
+        }
+    }
+}
+
+int EqualizerAudioProcessor::getSmoothingSubBlockSize() const
+{
+    // Matches the "Smoothing" choices, 0 means smoothing is off
+    static constexpr std::array<int, 4> subBlockSizes{ 0, 16, 32, 64 };
+
+    auto choice = juce::jlimit(0, (int)subBlockSizes.size() - 1, (int)smoothingParameter->load());
+    return subBlockSizes[(size_t)choice];
+}
+
+ProcessingMode EqualizerAudioProcessor::getProcessingMode(int numChannels) const
+{
+    // Left/right and mid/side only mean something with exactly two channels
+    if (numChannels != 2)
+        return Stereo;
+
+    return static_cast<ProcessingMode>(juce::jlimit(0, NumProcessingModes - 1, (int)processingModeParameter->load()));
+}
+
+EqualizerAudioProcessor::ChannelRole EqualizerAudioProcessor::getChannelRole(int channel) const
+{
+    // In the mid/side modes channel 0 holds mid and channel 1 side
+    switch (activeProcessingMode)
+    {
+    case LeftOnly:
+    case MidOnly:   return channel == 0 ? ChannelRole::main : ChannelRole::bypassed;
+    case RightOnly:
+    case SideOnly:  return channel == 1 ? ChannelRole::main : ChannelRole::bypassed;
+    case MidSide:   return channel == 0 ? ChannelRole::main : ChannelRole::side;
+    case Stereo:
+    default:        return ChannelRole::main;
+    }
+}
+
+//==============================================================================
+void ChainSmoother::reset(double sampleRate, double rampLengthSeconds)
+{
+	lowCutFreq.reset(sampleRate, rampLengthSeconds);
+	highCutFreq.reset(sampleRate, rampLengthSeconds);
+
+	for (size_t band = 0; band < (size_t)maxParametricBands; ++band)
+	{
+		bandFreqs[band].reset(sampleRate, rampLengthSeconds);
+		bandQualities[band].reset(sampleRate, rampLengthSeconds);
+		bandGains[band].reset(sampleRate, rampLengthSeconds);
+	}
+}
+
+void ChainSmoother::setTargets(const ChainSettings& chainSettings, bool jumpToTargets)
+{
+	targetSettings = chainSettings;
+
+	auto setTarget = [jumpToTargets](auto& smoothedValue, float target)
+		{
+			if (jumpToTargets)
+				smoothedValue.setCurrentAndTargetValue(target);
+			else
+				smoothedValue.setTargetValue(target);
+		};
+
+	setTarget(lowCutFreq, chainSettings.lowCutFreq);
+	setTarget(highCutFreq, chainSettings.highCutFreq);
+
+	for (size_t band = 0; band < (size_t)maxParametricBands; ++band)
+	{
+		const auto& bandSettings = chainSettings.bands[band];
+
+		setTarget(bandFreqs[band], bandSettings.freq);
+		setTarget(bandGains[band], bandSettings.gainInDecibels);
+		setTarget(bandQualities[band], bandSettings.quality);
+	}
+}
+
+int ChainSmoother::getSmoothingBands() const
+{
+	int bands = 0;
+
+	if (lowCutFreq.isSmoothing())
+		bands |= LowCutBand;
+
+	if (highCutFreq.isSmoothing())
+		bands |= HighCutBand;
+
+	for (size_t band = 0; band < (size_t)maxParametricBands; ++band)
+		if (bandFreqs[band].isSmoothing() || bandGains[band].isSmoothing() || bandQualities[band].isSmoothing())
+			bands |= getParametricBandMask((int)band);
+
+	return bands;
+}
+
+void ChainSmoother::update(int numSamples, double sampleRate)
+{
+	// Checked before skipping, so the last step of a ramp still lands exactly on the target
+	auto bands = getSmoothingBands();
+
+	auto chainSettings = targetSettings;
+	chainSettings.lowCutFreq = lowCutFreq.skip(numSamples);
+	chainSettings.highCutFreq = highCutFreq.skip(numSamples);
+
+	for (size_t band = 0; band < (size_t)maxParametricBands; ++band)
+	{
+		auto& bandSettings = chainSettings.bands[band];
+
+		bandSettings.freq = bandFreqs[band].skip(numSamples);
+		bandSettings.gainInDecibels = bandGains[band].skip(numSamples);
+		bandSettings.quality = bandQualities[band].skip(numSamples);
+	}
+
+	designChainCoefficients(coefficients, chainSettings, sampleRate, bands);
 }
 
 //==============================================================================
@@ -210,8 +649,11 @@ void EqualizerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
 
+    auto state = apvts.copyState();
+    state.appendChild(analyzerSettings.createCopy(), nullptr);
+
     juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    state.writeToStream(mos);
 }
 
 void EqualizerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -222,113 +664,615 @@ void EqualizerAudioProcessor::setStateInformation (const void* data, int sizeInB
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid())
     {
+        // Copying the properties keeps the editor's listeners on analyzerSettings attached
+        auto savedAnalyzerSettings = tree.getChildWithName(analyzerSettings.getType());
+        if (savedAnalyzerSettings.isValid())
+        {
+            analyzerSettings.copyPropertiesFrom(savedAnalyzerSettings, nullptr);
+            tree.removeChild(savedAnalyzerSettings, nullptr);
+        }
+
         apvts.replaceState(tree);
-        updateFilters();
+        coefficientDesigner.markDirty(AllBands);
+        sideCoefficientDesigner.markDirty(AllBands);
+    }
+}
+
+void EqualizerAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(pendingLatencySamples.load());
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterPrefix)
+{
+    auto get = [&apvts, &parameterPrefix](const juce::String& parameterName)
+        {
+            auto* value = apvts.getRawParameterValue(parameterPrefix + parameterName);
+            jassert(value != nullptr);
+            return value;
+        };
+
+    lowCut = { get("LowCut Freq"), get("LowCut Slope"), get("LowCut Bypassed") };
+    highCut = { get("HighCut Freq"), get("HighCut Slope"), get("HighCut Bypassed") };
+
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        auto getBand = [&get, band](const char* parameterName) { return get(getBandParameterID(band, parameterName)); };
+
+        bands[(size_t)band] = { getBand("Type"), getBand("Freq"), getBand("Gain"), getBand("Quality"), getBand("Bypassed") };
     }
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) 
+ChainSettings ChainParameters::load() const
 {
     ChainSettings settings;
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    settings.lowCutFreq = lowCut.freq->load();
+    settings.highCutFreq = highCut.freq->load();
+    settings.lowCutSlope = static_cast<Slope>(lowCut.slope->load());
+    settings.highCutSlope = static_cast<Slope>(highCut.slope->load());
+
+    settings.lowCutBypassed = lowCut.bypassed->load() > 0.5f;
+    settings.highCutBypassed = highCut.bypassed->load() > 0.5f;
 
-    settings.lowCutBypassed = apvts.getRawParameterValue("LowCut Bypassed")->load() > 0.5f;
-    settings.highCutBypassed = apvts.getRawParameterValue("HighCut Bypassed")->load() > 0.5f;
-    settings.peakBypassed = apvts.getRawParameterValue("Peak Bypassed")->load() > 0.5f;
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        const auto& parameters = bands[band];
+
+        auto& bandSettings = settings.bands[band];
+        bandSettings.type = static_cast<BandType>(parameters.type->load());
+        bandSettings.freq = parameters.freq->load();
+        bandSettings.gainInDecibels = parameters.gain->load();
+        bandSettings.quality = parameters.quality->load();
+        bandSettings.bypassed = parameters.bypassed->load() > 0.5f;
+    }
 
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterPrefix) 
+{
+    return ChainParameters(apvts, parameterPrefix).load();
+}
+
+Coefficients makePeakFilter(const BandSettings& bandSettings, double sampleRate)
 {
 	return juce::dsp::IIR::Coefficients<float>::makePeakFilter(
 		   sampleRate,
-		   chainSettings.peakFreq,
-		   chainSettings.peakQuality,
-		   juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+		   bandSettings.freq,
+		   bandSettings.quality,
+		   juce::Decibels::decibelsToGain(bandSettings.gainInDecibels));
 }
 
 
-void EqualizerAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+static BiquadCoefficients makeNormalisedBiquad(double b0, double b1, double b2, double a0, double a1, double a2)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+	auto a0Inverse = 1.0 / a0;
 
-	leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-	rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+	return { b0 * a0Inverse, b1 * a0Inverse, b2 * a0Inverse, a1 * a0Inverse, a2 * a0Inverse };
+}
 
-	updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-	updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+BiquadCoefficients makePeakBiquad(double sampleRate, double frequency, double quality, double gainFactor)
+{
+	auto A = std::sqrt(juce::jmax(0.0, gainFactor));
+	auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+	auto alpha = std::sin(omega) / (quality * 2.0);
+	auto c2 = -2.0 * std::cos(omega);
+	auto alphaTimesA = alpha * A;
+	auto alphaOverA = alpha / A;
+
+	return makeNormalisedBiquad(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+		1.0 + alphaOverA, c2, 1.0 - alphaOverA);
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+BiquadCoefficients makeLowPassBiquad(double sampleRate, double frequency, double quality)
 {
-	*old = *replacements;
+	auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+	auto nSquared = n * n;
+	auto invQ = 1.0 / quality;
+	auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+	return makeNormalisedBiquad(c1, c1 * 2.0, c1,
+		1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
 }
 
-void EqualizerAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+BiquadCoefficients makeHighPassBiquad(double sampleRate, double frequency, double quality)
 {
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get <ChainPositions::LowCut>();
+	auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+	auto nSquared = n * n;
+	auto invQ = 1.0 / quality;
+	auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
 
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+	return makeNormalisedBiquad(c1, c1 * -2.0, c1,
+		1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+}
 
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
+BiquadCoefficients makeLowShelfBiquad(double sampleRate, double frequency, double quality, double gainFactor)
+{
+	auto A = std::sqrt(juce::jmax(0.0, gainFactor));
+	auto aminus1 = A - 1.0;
+	auto aplus1 = A + 1.0;
+	auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+	auto coso = std::cos(omega);
+	auto beta = std::sin(omega) * std::sqrt(A) / quality;
+	auto aminus1TimesCoso = aminus1 * coso;
+
+	return makeNormalisedBiquad(A * (aplus1 - aminus1TimesCoso + beta),
+		A * 2.0 * (aminus1 - aplus1 * coso),
+		A * (aplus1 - aminus1TimesCoso - beta),
+		aplus1 + aminus1TimesCoso + beta,
+		-2.0 * (aminus1 + aplus1 * coso),
+		aplus1 + aminus1TimesCoso - beta);
 }
 
-void EqualizerAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+BiquadCoefficients makeHighShelfBiquad(double sampleRate, double frequency, double quality, double gainFactor)
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-	auto& leftHightCut = leftChain.get<ChainPositions::HighCut>();
-	auto& rightHightCut = rightChain.get<ChainPositions::HighCut>();
+	auto A = std::sqrt(juce::jmax(0.0, gainFactor));
+	auto aminus1 = A - 1.0;
+	auto aplus1 = A + 1.0;
+	auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+	auto coso = std::cos(omega);
+	auto beta = std::sin(omega) * std::sqrt(A) / quality;
+	auto aminus1TimesCoso = aminus1 * coso;
+
+	return makeNormalisedBiquad(A * (aplus1 + aminus1TimesCoso + beta),
+		A * -2.0 * (aminus1 + aplus1 * coso),
+		A * (aplus1 + aminus1TimesCoso - beta),
+		aplus1 - aminus1TimesCoso + beta,
+		2.0 * (aminus1 - aplus1 * coso),
+		aplus1 - aminus1TimesCoso - beta);
+}
 
-	leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-	rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+BiquadCoefficients makeNotchBiquad(double sampleRate, double frequency, double quality)
+{
+	auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+	auto alpha = std::sin(omega) / (quality * 2.0);
+	auto c2 = -2.0 * std::cos(omega);
 
-	updateCutFilter(leftHightCut, highCutCoefficients, chainSettings.highCutSlope);
-	updateCutFilter(rightHightCut, highCutCoefficients, chainSettings.highCutSlope);
+	return makeNormalisedBiquad(1.0, c2, 1.0, 1.0 + alpha, c2, 1.0 - alpha);
 }
 
-void EqualizerAudioProcessor::updateFilters()
+BiquadCoefficients makeBandPassBiquad(double sampleRate, double frequency, double quality)
 {
-    auto chainSettings = getChainSettings(apvts);
+	// 0 dB at the centre frequency
+	auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+	auto alpha = std::sin(omega) / (quality * 2.0);
+	auto c2 = -2.0 * std::cos(omega);
 
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+	return makeNormalisedBiquad(alpha, 0.0, -alpha, 1.0 + alpha, c2, 1.0 - alpha);
 }
 
-juce::AudioProcessorValueTreeState::ParameterLayout
-    EqualizerAudioProcessor::createParameterLayout()
+BiquadCoefficients makeTiltBiquad(double sampleRate, double frequency, double quality, double gainFactor)
+{
+	// A high shelf by the whole gain, lowered by half of it
+	auto coefficients = makeHighShelfBiquad(sampleRate, frequency, quality, gainFactor);
+	auto scale = 1.0 / std::sqrt(juce::jmax(1.0e-6, gainFactor));
+
+	coefficients.b0 *= scale;
+	coefficients.b1 *= scale;
+	coefficients.b2 *= scale;
+
+	return coefficients;
+}
+
+BiquadCoefficients makeBandBiquad(const BandSettings& bandSettings, double sampleRate)
+{
+	const auto frequency = (double)bandSettings.freq;
+	const auto quality = (double)bandSettings.quality;
+	const auto gainFactor = juce::Decibels::decibelsToGain((double)bandSettings.gainInDecibels);
+
+	switch (bandSettings.type)
+	{
+	case LowShelf:  return makeLowShelfBiquad(sampleRate, frequency, quality, gainFactor);
+	case HighShelf: return makeHighShelfBiquad(sampleRate, frequency, quality, gainFactor);
+	case Notch:     return makeNotchBiquad(sampleRate, frequency, quality);
+	case Tilt:      return makeTiltBiquad(sampleRate, frequency, quality, gainFactor);
+	case BandPass:  return makeBandPassBiquad(sampleRate, frequency, quality);
+	case Bell:
+	default:        return makePeakBiquad(sampleRate, frequency, quality, gainFactor);
+	}
+}
+
+double getButterworthQuality(int stage, int numStages)
+{
+	// Same pole placement as FilterDesign::designIIR...HighOrderButterworthMethod for even orders
+	auto order = 2.0 * numStages;
+	return 1.0 / (2.0 * std::cos((2.0 * stage + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+}
+
+void designChainCoefficients(ChainCoefficients& destination,
+	const ChainSettings& chainSettings,
+	double sampleRate,
+	int bands)
+{
+	destination.settings = chainSettings;
+
+	auto designCutStages = [sampleRate](auto& stages, float frequency, Slope slope, auto makeBiquad)
+		{
+			const auto numStages = getNumCutStages(slope);
+
+			for (int i = 0; i < numStages; ++i)
+				stages[(size_t)i] = makeBiquad(sampleRate, frequency, getButterworthQuality(i, numStages));
+		};
+
+	if (bands & LowCutBand)
+		designCutStages(destination.lowCut, chainSettings.lowCutFreq, chainSettings.lowCutSlope, makeHighPassBiquad);
+
+	// Both lists are in band order, so the previous slot of each band is found in the same pass
+	const auto previous = destination.bands;
+	auto& packed = destination.bands;
+	int previousSlot = 0;
+	packed.numActive = 0;
+
+	for (int band = 0; band < maxParametricBands; ++band)
+	{
+		const auto& bandSettings = chainSettings.bands[(size_t)band];
+
+		while (previousSlot < previous.numActive && previous.bandIndex[(size_t)previousSlot] < band)
+			++previousSlot;
+
+		if (bandSettings.bypassed)
+			continue;
+
+		const auto wasActive = previousSlot < previous.numActive && previous.bandIndex[(size_t)previousSlot] == band;
+
+		if ((bands & getParametricBandMask(band)) != 0 || !wasActive)
+			packed.set(packed.numActive, band, makeBandBiquad(bandSettings, sampleRate));
+		else
+			packed.set(packed.numActive, band, previous.get(previousSlot));
+
+		++packed.numActive;
+	}
+
+	if (bands & HighCutBand)
+		designCutStages(destination.highCut, chainSettings.highCutFreq, chainSettings.highCutSlope, makeLowPassBiquad);
+}
+
+double getChainMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency, double sampleRate)
+{
+	const auto& chainSettings = chainCoefficients.settings;
+	double mag = 1.0;
+
+	for (int i = 0; i < chainCoefficients.bands.numActive; ++i)
+		mag *= getMagnitudeForFrequency(chainCoefficients.bands.get(i), frequency, sampleRate);
+
+	if (!chainSettings.lowCutBypassed)
+	{
+		for (int stage = 0; stage < getNumCutStages(chainSettings.lowCutSlope); ++stage)
+			mag *= getMagnitudeForFrequency(chainCoefficients.lowCut[(size_t)stage], frequency, sampleRate);
+	}
+
+	if (!chainSettings.highCutBypassed)
+	{
+		for (int stage = 0; stage < getNumCutStages(chainSettings.highCutSlope); ++stage)
+			mag *= getMagnitudeForFrequency(chainCoefficients.highCut[(size_t)stage], frequency, sampleRate);
+	}
+
+	return mag;
+}
+
+//==============================================================================
+void ChainMagnitudeEvaluator::prepare(const double* frequencies, int newNumFrequencies, double sampleRate)
+{
+	numFrequencies = newNumFrequencies;
+
+	const auto numRegisters = (size_t)((numFrequencies + (int)Register::size() - 1) / (int)Register::size());
+	cosines.resize(numRegisters);
+	numerators.resize(numRegisters);
+	denominators.resize(numRegisters);
+
+	for (int i = 0; i < (int)(numRegisters * Register::size()); ++i)
+	{
+		// The padding repeats the last frequency, so it stays finite
+		const auto frequency = frequencies[juce::jmin(i, numFrequencies - 1)];
+		const auto cosine = std::cos(juce::MathConstants<double>::twoPi * frequency / sampleRate);
+
+		cosines[(size_t)i / Register::size()].set((size_t)i % Register::size(), cosine);
+	}
+}
+
+void ChainMagnitudeEvaluator::applySection(const BiquadCoefficients& c)
+{
+	// |b0 + b1 z^-1 + b2 z^-2|^2 = b0^2 + b1^2 + b2^2 + 2 (b0 b1 + b1 b2) cos w + 2 b0 b2 cos 2w,
+	// with cos 2w = 2 cos^2 w - 1, and the same for the denominator with b0 = 1
+	const auto n0 = Register::expand(c.b0 * c.b0 + c.b1 * c.b1 + c.b2 * c.b2 - 2.0 * c.b0 * c.b2);
+	const auto n1 = Register::expand(2.0 * (c.b0 * c.b1 + c.b1 * c.b2));
+	const auto n2 = Register::expand(4.0 * c.b0 * c.b2);
+
+	const auto d0 = Register::expand(1.0 + c.a1 * c.a1 + c.a2 * c.a2 - 2.0 * c.a2);
+	const auto d1 = Register::expand(2.0 * (c.a1 + c.a1 * c.a2));
+	const auto d2 = Register::expand(4.0 * c.a2);
+
+	for (size_t i = 0; i < cosines.size(); ++i)
+	{
+		const auto cosine = cosines[i];
+
+		numerators[i] *= (n2 * cosine + n1) * cosine + n0;
+		denominators[i] *= (d2 * cosine + d1) * cosine + d0;
+	}
+}
+
+void ChainMagnitudeEvaluator::process(const ChainCoefficients& chainCoefficients, double* decibels)
+{
+	const auto& chainSettings = chainCoefficients.settings;
+
+	std::fill(numerators.begin(), numerators.end(), Register::expand(1.0));
+	std::fill(denominators.begin(), denominators.end(), Register::expand(1.0));
+
+	// Numerators and denominators are multiplied up separately, which leaves a single division per frequency
+	for (int i = 0; i < chainCoefficients.bands.numActive; ++i)
+		applySection(chainCoefficients.bands.get(i));
+
+	if (!chainSettings.lowCutBypassed)
+	{
+		for (int stage = 0; stage < getNumCutStages(chainSettings.lowCutSlope); ++stage)
+			applySection(chainCoefficients.lowCut[(size_t)stage]);
+	}
+
+	if (!chainSettings.highCutBypassed)
+	{
+		for (int stage = 0; stage < getNumCutStages(chainSettings.highCutSlope); ++stage)
+			applySection(chainCoefficients.highCut[(size_t)stage]);
+	}
+
+	for (int i = 0; i < numFrequencies; ++i)
+	{
+		const auto index = (size_t)i / Register::size();
+		const auto lane = (size_t)i % Register::size();
+
+		const auto squaredMagnitude = numerators[index].get(lane) / denominators[index].get(lane);
+		decibels[i] = juce::jmax(-100.0, 10.0 * std::log10(squaredMagnitude));
+	}
+}
+
+void EqualizerAudioProcessor::updateFilters(const ChainCoefficients& chainCoefficients)
+{
+    for (auto* chain : channelGroupChains)
+        updateChainFilters(*chain, chainCoefficients);
+
+    mainCoefficients = &chainCoefficients;
+    updateMidSideChain();
+}
+
+void EqualizerAudioProcessor::updateSideFilters(const ChainCoefficients& chainCoefficients)
+{
+    sideCoefficients = &chainCoefficients;
+    updateMidSideChain();
+}
+
+void EqualizerAudioProcessor::updateMidSideChain()
+{
+    // Only kept up to date while it's used, switching the mode brings it up to date again
+    if (activeProcessingMode != MidSide || mainCoefficients == nullptr || sideCoefficients == nullptr)
+        return;
+
+    std::array<const ChainCoefficients*, SIMDSample::size()> lanes;
+    lanes.fill(mainCoefficients);
+    lanes[1] = sideCoefficients;
+
+    updateChainLanes(*midSideChain, lanes);
+}
+
+//==============================================================================
+DesignerWakeTimer::DesignerWakeTimer()
+{
+	startTimer(intervalMs);
+}
+
+DesignerWakeTimer::~DesignerWakeTimer()
+{
+	stopTimer();
+}
+
+void DesignerWakeTimer::add(CoefficientDesigner& designer)
+{
+	const juce::ScopedLock sl(lock);
+	designers.addIfNotAlreadyThere(&designer);
+}
+
+void DesignerWakeTimer::remove(CoefficientDesigner& designer)
+{
+	const juce::ScopedLock sl(lock);
+	designers.removeFirstMatchingValue(&designer);
+}
+
+void DesignerWakeTimer::timerCallback()
+{
+	const juce::ScopedLock sl(lock);
+
+	for (auto* designer : designers)
+		designer->wakeIfDirty();
+}
+
+//==============================================================================
+CoefficientDesigner::CoefficientDesigner(juce::AudioProcessorValueTreeState& state, const juce::String& prefix) :
+	juce::Thread("Coefficient Designer"),
+	apvts(state),
+	parameterPrefix(prefix),
+	parameters(state, prefix)
+{
+	bandMaskForParameter.resize((size_t)apvts.processor.getParameters().size(), 0);
+
+	// Only the parameters listed here get a listener at all
+	auto follow = [this](const juce::String& parameterID, int bands)
+		{
+			auto* param = apvts.getParameter(parameterID);
+			jassert(param != nullptr);
+
+			bandMaskForParameter[(size_t)param->getParameterIndex()] = bands;
+			param->addListener(this);
+		};
+
+	// Only this designer's set, the other designer follows the other one
+	for (auto* name : cutParameterNames)
+	{
+		follow(parameterPrefix + "LowCut " + name, LowCutBand);
+		follow(parameterPrefix + "HighCut " + name, HighCutBand);
+	}
+
+	for (int band = 0; band < maxParametricBands; ++band)
+		for (auto* name : bandParameterNames)
+			follow(parameterPrefix + getBandParameterID(band, name), getParametricBandMask(band));
+
+	// The kernel isn't kept up to date while the mode is off
+	follow("Linear Phase", AllBands);
+	linearPhaseParameter = apvts.getRawParameterValue("Linear Phase");
+	linearPhaseParameterIndex = apvts.getParameter("Linear Phase")->getParameterIndex();
+
+	wakeTimer->add(*this);
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+	wakeTimer->remove(*this);
+	release();
+
+	for (auto* param : apvts.processor.getParameters())
+		if (bandMaskForParameter[(size_t)param->getParameterIndex()] != 0)
+			param->removeListener(this);
+}
+
+ChainCoefficients CoefficientDesigner::prepare(double newSampleRate)
 {
+	release();
+
+	sampleRate = newSampleRate;
+	dirtyBands.store(0);
+	designChainCoefficients(designed, parameters.load(), sampleRate, AllBands);
+
+	coefficientBuffer.reset();
+	auto initial = designed;
+
+	// Every slot is sized up front, so the designer thread only ever overwrites kernels in place
+	kernelDesigner.prepare(sampleRate, getLinearPhaseKernelLength(sampleRate), linearPhasePartitionSize);
+	kernelBuffer.reset();
+
+	const LinearPhaseKernel* initialKernel = nullptr;
+
+	kernelBuffer.forEachBuffer([this, &initialKernel](LinearPhaseKernel& kernel)
+		{
+			if (initialKernel != nullptr)
+			{
+				kernel = *initialKernel;
+				return;
+			}
+
+			if (linearPhaseParameter->load() > 0.5f)
+			{
+				kernelDesigner.design(kernel, [this](double frequency) { return getChainMagnitudeForFrequency(designed, frequency, sampleRate); });
+				kernel.linearPhaseSwitch = linearPhaseSwitches.load();
+			}
+			else
+			{
+				kernelDesigner.designDelay(kernel);
+				kernel.linearPhaseSwitch = -1;
+			}
+
+			initialKernel = &kernel;
+		});
+
+	startThread();
+
+	return initial;
+}
+
+void CoefficientDesigner::release()
+{
+	stopThread(1000);
+}
+
+void CoefficientDesigner::markDirty(int bands)
+{
+	dirtyBands.fetch_or(bands, std::memory_order_release);
+
+	// Signalling the thread takes a lock, which the message thread can afford
+	if (juce::MessageManager::existsAndIsCurrentThread())
+		notify();
+}
+
+void CoefficientDesigner::wakeIfDirty()
+{
+	if (dirtyBands.load(std::memory_order_relaxed) != 0)
+		notify();
+}
+
+void CoefficientDesigner::parameterValueChanged(int parameterIndex, float newValue)
+{
+	juce::ignoreUnused(newValue);
+
+	// Counted before the bands are flagged, so the kernel designed for them carries the new count
+	if (parameterIndex == linearPhaseParameterIndex)
+		linearPhaseSwitches.fetch_add(1, std::memory_order_acq_rel);
+
+	// Can be called from any thread (including the audio thread), so only flag the bands here
+	if (juce::isPositiveAndBelow(parameterIndex, (int)bandMaskForParameter.size()))
+		if (const auto bands = bandMaskForParameter[(size_t)parameterIndex]; bands != 0)
+			markDirty(bands);
+}
+
+void CoefficientDesigner::run()
+{
+	while (!threadShouldExit())
+	{
+		auto bands = dirtyBands.exchange(0, std::memory_order_acquire);
+
+		// Sleeps until markDirty() or DesignerWakeTimer wakes it, or stopThread() is called
+		if (bands == 0)
+		{
+			wait(-1);
+			continue;
+		}
+
+		// Read before the settings, so a switch during the design leaves the kernel out of date
+		const auto linearPhaseSwitch = linearPhaseSwitches.load(std::memory_order_acquire);
+
+		designChainCoefficients(designed, parameters.load(), sampleRate, bands);
+
+		coefficientBuffer.getWriteBuffer() = designed;
+		coefficientBuffer.publish();
+
+		if (linearPhaseParameter->load() > 0.5f)
+			publishKernel(linearPhaseSwitch);
+	}
+}
+
+void CoefficientDesigner::publishKernel(int linearPhaseSwitch)
+{
+	auto& kernel = kernelBuffer.getWriteBuffer();
+
+	kernelDesigner.design(kernel, [this](double frequency)
+		{
+			return getChainMagnitudeForFrequency(designed, frequency, sampleRate);
+		});
+
+	kernel.linearPhaseSwitch = linearPhaseSwitch;
+	kernelBuffer.publish();
+}
+
+// One full set of filter parameters, the IDs starting with 'prefix'
+// The first set was released without version hints, which is the same as version 0
+static void addChainParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, const juce::String& prefix, int versionHint)
+{
+    auto id = [&prefix, versionHint](const char* name) { return juce::ParameterID{ prefix + name, versionHint }; };
+
     // LowCut Freq
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq", "LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(id("LowCut Freq"), prefix + "LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
 
     // HighCut Freq 
-	layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq", "HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(id("HighCut Freq"), prefix + "HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
 
     // Peak
-	layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq", "Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Freq"), prefix + "Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));
 
     // Peak gain
-	layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain", "Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Gain"), prefix + "Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
 
     // Peak Quality
-	layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality", "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Quality"), prefix + "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
 
     // Slopes
     juce::StringArray stringArray;
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < NumSlopes; ++i)
     {
         juce::String str;
         str << (12 + i * 12);
@@ -336,15 +1280,70 @@ juce::AudioProcessorValueTreeState::ParameterLayout
         stringArray.add(str);
     }
 
-	layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(id("LowCut Slope"), prefix + "LowCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(id("HighCut Slope"), prefix + "HighCut Slope", stringArray, 0));
 
     // Bypass buttons
-    layout.add(std::make_unique<juce::AudioParameterBool>("LowCut Bypassed", "LowCut Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Bypassed", "Peak Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(id("LowCut Bypassed"), prefix + "LowCut Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(id("Peak Bypassed"), prefix + "Peak Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(id("HighCut Bypassed"), prefix + "HighCut Bypassed", false));
+}
+
+// The parametric bands that came after the single peak band, which is band 1. Its type is new too.
+static void addBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, const juce::String& prefix)
+{
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        auto getID = [&prefix, band](const char* parameterName) { return prefix + getBandParameterID(band, parameterName); };
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ getID("Type"), 1 }, getID("Type"),
+            juce::StringArray{ "Bell", "Low Shelf", "High Shelf", "Notch", "Tilt", "Band Pass" }, 0));
+
+        if (band == 0)
+            continue;
+
+        // Spread over the spectrum, so bands switched on in the editor don't all start in the same place
+        const auto defaultFreq = std::round((float)juce::mapToLog10((band + 0.5) / maxParametricBands, 20.0, 20000.0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ getID("Freq"), 1 }, getID("Freq"), juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), defaultFreq));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ getID("Gain"), 1 }, getID("Gain"), juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ getID("Quality"), 1 }, getID("Quality"), juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+
+        // Only band 1 starts out enabled, like the peak band did
+        layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ getID("Bypassed"), 1 }, getID("Bypassed"), true));
+    }
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout
+    EqualizerAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    addChainParameters(layout, {}, 0);
+
     layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
 
+    // Everything below was added after the parameters above were released. New parameters go
+    // at the end with a version hint, so automation and the indices hosts know them by stay put.
+
+    // Parameter smoothing, redesigning the filters every N samples while a parameter moves
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ "Smoothing", 1 }, "Smoothing",
+        juce::StringArray{ "Off", "16 Samples", "32 Samples", "64 Samples" }, 0));
+
+    // Linear phase mode changes the latency, which hosts can't follow during automation
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ "Linear Phase", 1 }, "Linear Phase", false,
+        juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
+    // Switching modes clears the filter state, so it isn't meant to be automated either
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ "Processing Mode", 1 }, "Processing Mode",
+        juce::StringArray{ "Stereo", "Left", "Right", "Mid", "Side", "Mid/Side" }, 0,
+        juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+
+    // Side in Mid/Side mode
+    addChainParameters(layout, sideParameterPrefix, 1);
+
+    addBandParameters(layout, {});
+    addBandParameters(layout, sideParameterPrefix);
+
     return layout;
 }
 
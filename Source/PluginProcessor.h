@@ -12,25 +12,13 @@
 
 #include <array>
 
-// FIFO that the GUI thread can use to retrieve blocks produced in SingleChannelSampleFIFO
+#include "BiquadKernels.h"
+#include "LinearPhaseConvolver.h"
+
+// FIFO that the GUI thread uses to hand FFT data and paths between the analyzer stages
 template<typename T>
 struct Fifo
 {
-	void prepare(int numChannels, int numSamples)
-	{
-		static_assert(std::is_same_v<T, juce::AudioBuffer<float>>,
-			"prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
-		for (auto& buffer : buffers)
-		{
-			buffer.setSize(numChannels,
-				numSamples,
-				false,   //clear everything?
-				true,    //including the extra space?
-				true);   //avoid reallocating if you can?
-			buffer.clear();
-		}
-	}
-
 	void prepare(size_t numElements)
 	{
 		static_assert(std::is_same_v<T, std::vector<float>>,
@@ -83,72 +71,119 @@ enum Channel
     Left // effectively 1
 };
 
-// Collecting samples into blocks of fixed sizes
-
+// Audio to GUI tap for one channel: a single producer, single consumer ring of raw samples.
+// The audio thread copies each block in with at most two copies and never allocates,
+// the GUI reads whatever chunk size it analyses in straight out of it.
 template<typename BlockType>
 struct SingleChannelSampleFifo
 {
-	SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
+	static constexpr int defaultCapacity = 1 << 15;
+
+	// The ring is allocated once, here, so neither side ever allocates afterwards.
+	// AbstractFifo keeps one slot free to tell full from empty.
+	SingleChannelSampleFifo(Channel ch, int capacityToUse = defaultCapacity) :
+		channelToUse(ch),
+		capacity(capacityToUse),
+		fifo(capacityToUse + 1)
 	{
 		prepared.set(false);
+		samples.allocate((size_t)capacity + 1, true);
 	}
 
 	void update(const BlockType& buffer)
 	{
 		jassert(prepared.get());
-		jassert(buffer.getNumChannels() > channelToUse);
-		auto* channelPtr = buffer.getReadPointer(channelToUse);
+		jassert(buffer.getNumChannels() > 0);
+
+		// Mono layouts only have one channel to show
+		auto* channelPtr = buffer.getReadPointer(juce::jmin((int)channelToUse, buffer.getNumChannels() - 1));
 
-		for (int i = 0; i < buffer.getNumSamples(); ++i)
+		const auto numSamples = buffer.getNumSamples();
+		const auto numToWrite = juce::jmin(numSamples, fifo.getFreeSpace());
+
+		// The GUI fell behind, the rest of this block is lost
+		if (numToWrite < numSamples)
 		{
-			pushNextSampleIntoFifo(channelPtr[i]);
+			numOverruns.fetch_add(1, std::memory_order_relaxed);
+			numDroppedSamples.fetch_add(numSamples - numToWrite, std::memory_order_relaxed);
 		}
+
+		const auto write = fifo.write(numToWrite);
+
+		if (write.blockSize1 > 0)
+			juce::FloatVectorOperations::copy(samples.get() + write.startIndex1, channelPtr, write.blockSize1);
+
+		if (write.blockSize2 > 0)
+			juce::FloatVectorOperations::copy(samples.get() + write.startIndex2, channelPtr + write.blockSize1, write.blockSize2);
 	}
 
-	void prepare(int bufferSize)
+	// Audio side. The reader may be running, so this only asks it to drop what's queued:
+	// resetting the read index from here would race with the reader moving it.
+	void prepare()
 	{
-		prepared.set(false);
-		size.set(bufferSize);
-
-		bufferToFill.setSize(1,    //channel
-			bufferSize,            //num samples
-			false,                 //keepExistingContent
-			true,                  //clear extra space
-			true);                 //avoid reallocating
+		resetGeneration.fetch_add(1, std::memory_order_release);
 
-		audioBufferFifo.prepare(1, bufferSize);
-		fifoIndex = 0;
+		numOverruns.store(0);
+		numDroppedSamples.store(0);
 		prepared.set(true);
 	}
 	//==============================================================================
-	int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
+	// Reader side, like pull()
+	int getNumSamplesAvailable()
+	{
+		discardIfReset();
+		return fifo.getNumReady();
+	}
+
 	bool isPrepared() const { return prepared.get(); }
-	int getSize() const { return size.get(); }
+	int getCapacity() const { return capacity; }
+
+	// Number of blocks the audio thread couldn't fit in completely, and the samples lost that way
+	int getNumOverruns() const { return numOverruns.load(std::memory_order_relaxed); }
+	juce::int64 getNumDroppedSamples() const { return numDroppedSamples.load(std::memory_order_relaxed); }
 	//==============================================================================
-	bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+	// Copies up to numSamples of the oldest samples to 'destination', returns how many were read
+	int pull(float* destination, int numSamples)
+	{
+		discardIfReset();
 
-private:
-	Channel channelToUse;
-	int fifoIndex = 0;
-	Fifo<BlockType> audioBufferFifo;
-	BlockType bufferToFill;
-	juce::Atomic<bool> prepared = false;
-	juce::Atomic<int> size = 0;
+		const auto read = fifo.read(juce::jmin(numSamples, fifo.getNumReady()));
+
+		if (read.blockSize1 > 0)
+			juce::FloatVectorOperations::copy(destination, samples.get() + read.startIndex1, read.blockSize1);
+
+		if (read.blockSize2 > 0)
+			juce::FloatVectorOperations::copy(destination + read.blockSize1, samples.get() + read.startIndex2, read.blockSize2);
+
+		return read.blockSize1 + read.blockSize2;
+	}
 
-	void pushNextSampleIntoFifo(float sample)
+private:
+	// Drops everything queued before the last prepare(). Whatever the audio thread wrote since
+	// goes too, which only costs a few samples of display.
+	void discardIfReset()
 	{
-		if (fifoIndex == bufferToFill.getNumSamples())
+		if (const auto generation = resetGeneration.load(std::memory_order_acquire); generation != readGeneration)
 		{
-			auto ok = audioBufferFifo.push(bufferToFill);
+			readGeneration = generation;
+			fifo.finishedRead(fifo.getNumReady());
+		}
+	}
 
-			juce::ignoreUnused(ok);
+	Channel channelToUse;
+	const int capacity;
 
-			fifoIndex = 0;
-		}
+	juce::HeapBlock<float> samples;
+	juce::AbstractFifo fifo;
 
-		bufferToFill.setSample(0, fifoIndex, sample);
-		++fifoIndex;
-	}
+	juce::Atomic<bool> prepared = false;
+
+	// Bumped by prepare(), only the reader clears the ring
+	std::atomic<int> resetGeneration{ 0 };
+	int readGeneration = 0;
+
+	std::atomic<int> numOverruns{ 0 };
+	std::atomic<juce::int64> numDroppedSamples{ 0 };
 };
 
 
@@ -158,75 +193,427 @@ enum Slope
     Slope_24,
     Slope_36,
     Slope_48,
+    Slope_60,
+    Slope_72,
+    Slope_84,
+    Slope_96,
+
+    NumSlopes
+};
+
+// Parametric bands in each parameter set. Bypassed ones cost nothing on the audio thread.
+constexpr int maxParametricBands = 24;
+
+enum BandType
+{
+	Bell,
+	LowShelf,
+	HighShelf,
+	Notch,
+	Tilt,       // the lows go down and the highs up by half the gain each, around the frequency
+	BandPass,
+
+	NumBandTypes
+};
+
+struct BandSettings
+{
+	BandType type{ BandType::Bell };
+	float freq{ 750.f }, gainInDecibels{ 0 }, quality{ 1.f };
+
+	bool bypassed{ true };
 };
 
 struct ChainSettings
 {
-    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
     float lowCutFreq{ 0 }, highCutFreq{ 0 };
 
     Slope lowCutSlope { Slope::Slope_12}, highCutSlope{ Slope::Slope_12 };
 
-	bool lowCutBypassed{ false }, peakBypassed{ false }, highCutBypassed{ false };
+	bool lowCutBypassed{ false }, highCutBypassed{ false };
+
+	std::array<BandSettings, maxParametricBands> bands;
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+// e.g. "Band 3 Freq" for the band at index 2. The first band took over the single peak band
+// and keeps its IDs ("Peak Freq" etc.), so existing sessions and automation still find them.
+inline juce::String getBandParameterID(int band, const char* parameterName)
+{
+	if (band == 0)
+		return juce::String("Peak ") + parameterName;
 
-using Filter = juce::dsp::IIR::Filter<float>;
+	return "Band " + juce::String(band + 1) + " " + parameterName;
+}
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+// The parameters every cut filter ("LowCut Freq" etc.) and every parametric band has
+inline constexpr std::array<const char*, 3> cutParameterNames{ "Freq", "Slope", "Bypassed" };
+inline constexpr std::array<const char*, 5> bandParameterNames{ "Type", "Freq", "Gain", "Quality", "Bypassed" };
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+// The raw values of one parameter set, looked up once so that reading the settings
+// doesn't build and look up every parameter ID again
+struct ChainParameters
+{
+	ChainParameters(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterPrefix = {});
 
-enum ChainPositions
+	ChainSettings load() const;
+
+private:
+	struct CutParameters
+	{
+		std::atomic<float>* freq;
+		std::atomic<float>* slope;
+		std::atomic<float>* bypassed;
+	};
+
+	struct BandParameters
+	{
+		std::atomic<float>* type;
+		std::atomic<float>* freq;
+		std::atomic<float>* gain;
+		std::atomic<float>* quality;
+		std::atomic<float>* bypassed;
+	};
+
+	CutParameters lowCut, highCut;
+	std::array<BandParameters, maxParametricBands> bands;
+};
+
+// The main settings have no prefix, the second set used for side in Mid/Side mode has sideParameterPrefix
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterPrefix = {});
+
+inline const juce::String sideParameterPrefix{ "Side " };
+
+// How the two channels of a stereo layout get filtered. Other layouts always use Stereo.
+enum ProcessingMode
 {
-	LowCut,
-	Peak,
-	HighCut
+	Stereo,     // both channels with the main settings
+	LeftOnly,
+	RightOnly,
+	MidOnly,
+	SideOnly,
+	MidSide,    // mid with the main settings, side with the "Side ..." ones
+
+	NumProcessingModes
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+inline bool usesMidSide(ProcessingMode mode) { return mode == MidOnly || mode == SideOnly || mode == MidSide; }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+// Every 12 dB/Oct is one second order section
+inline int getNumCutStages(Slope slope) { return static_cast<int>(slope) + 1; }
 
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
+// Butterworth cascade of second order sections, one per 12 dB/Oct. Instead of walking
+// every stage and checking bypass flags, setNumStages() picks a process function
+// specialised for that number of stages, so this only happens when the slope changes.
+template<typename SampleType>
+struct CutFilterOf
 {
-	updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-	chain.template setBypassed<Index>(false);
+	using StageType = Filter<SampleType>;
+	using ContextType = juce::dsp::ProcessContextReplacing<SampleType>;
+
+	static constexpr int maxStages = NumSlopes;
+	static constexpr size_t numLanes = getNumLanes<SampleType>();
+
+	void prepare(const juce::dsp::ProcessSpec& spec)
+	{
+		for (auto& stage : stages)
+			stage.prepare(spec);
+	}
+
+	void reset()
+	{
+		for (auto& stage : stages)
+			stage.reset();
+	}
+
+	void process(const ContextType& context)
+	{
+		// Set by the enclosing ProcessorChain when the whole section is bypassed
+		if (context.isBypassed)
+			return;
+
+		processFunction(stages, context);
+	}
+
+	void setNumStages(int newNumStages)
+	{
+		jassert(1 <= newNumStages && newNumStages <= maxStages);
+
+		laneNumStages.fill(newNumStages);
+
+		if (newNumStages == numStages)
+			return;
+
+		// Stages that weren't running until now shouldn't start from stale state
+		for (int i = numStages; i < newNumStages; ++i)
+			stages[(size_t)i].reset();
+
+		numStages = newNumStages;
+		processFunction = getProcessFunction(numStages);
+	}
+
+	// For chains whose lanes follow different settings, e.g. mid and side in one SIMD register.
+	// Runs as many stages as the lane needing the most, the other lanes pass the remaining ones
+	// through unchanged and lanes with 0 stages aren't filtered at all. Stages a lane didn't use
+	// until now start from silence in that lane. Returns false if no lane has any stages.
+	bool setLaneStages(const std::array<int, numLanes>& newLaneNumStages,
+		const std::array<const BiquadCoefficients*, numLanes>& laneCoefficients)
+	{
+		const auto previousLaneNumStages = laneNumStages;
+		const auto maxLaneStages = *std::max_element(newLaneNumStages.begin(), newLaneNumStages.end());
+
+		if (maxLaneStages == 0)
+		{
+			laneNumStages.fill(0);
+			return false;
+		}
+
+		setNumStages(maxLaneStages);
+
+		for (int i = 0; i < numStages; ++i)
+		{
+			auto& stage = stages[(size_t)i];
+
+			for (size_t lane = 0; lane < numLanes; ++lane)
+			{
+				if (i >= newLaneNumStages[lane])
+				{
+					stage.setCoefficients(lane, BiquadCoefficients{});
+					continue;
+				}
+
+				if (i >= previousLaneNumStages[lane])
+					stage.reset(lane);
+
+				stage.setCoefficients(lane, laneCoefficients[lane][i]);
+			}
+		}
+
+		laneNumStages = newLaneNumStages;
+		return true;
+	}
+
+	int getNumStages() const { return numStages; }
+
+	StageType& getStage(int index) { return stages[(size_t)index]; }
+	const StageType& getStage(int index) const { return stages[(size_t)index]; }
+
+private:
+	using Stages = std::array<StageType, maxStages>;
+	using ProcessFunction = void (*)(Stages&, const ContextType&);
+
+	template<int NumStages>
+	static void processStages(Stages& stagesToProcess, const ContextType& context)
+	{
+		for (int i = 0; i < NumStages; ++i)
+			stagesToProcess[(size_t)i].process(context);
+	}
+
+	static ProcessFunction getProcessFunction(int numStagesToProcess)
+	{
+		static_assert(maxStages == 8, "Update the jump table below when changing the number of slopes");
+
+		switch (numStagesToProcess)
+		{
+		case 1: return &processStages<1>;
+		case 2: return &processStages<2>;
+		case 3: return &processStages<3>;
+		case 4: return &processStages<4>;
+		case 5: return &processStages<5>;
+		case 6: return &processStages<6>;
+		case 7: return &processStages<7>;
+		default: return &processStages<8>;
+		}
+	}
+
+	Stages stages;
+	int numStages = 1;
+	ProcessFunction processFunction = &processStages<1>;
+
+	// Stages each lane actually filters with, only differs between lanes after setLaneStages()
+	std::array<int, numLanes> laneNumStages{};
 };
 
-template <typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain,
-	const CoefficientType& coefficients,
-	const Slope& slope)
+// Coefficients of the bands that aren't bypassed, packed to the front in band order with one
+// array per coefficient. Copying them to the audio thread or evaluating the response
+// only touches numActive entries, however many bands there are.
+struct PackedBandCoefficients
 {
-	chain.template setBypassed<0>(true);
-	chain.template setBypassed<1>(true);
-	chain.template setBypassed<2>(true);
-	chain.template setBypassed<3>(true);
+	int numActive = 0;
 
+	std::array<int, maxParametricBands> bandIndex{};
+	std::array<double, maxParametricBands> b0{}, b1{}, b2{}, a1{}, a2{};
 
-	switch (slope)
+	BiquadCoefficients get(int slot) const
 	{
-	case Slope_48:
+		const auto i = (size_t)slot;
+		return { b0[i], b1[i], b2[i], a1[i], a2[i] };
+	}
+
+	void set(int slot, int band, const BiquadCoefficients& coefficients)
 	{
-		update<3>(chain, coefficients);
+		const auto i = (size_t)slot;
+		bandIndex[i] = band;
+		b0[i] = coefficients.b0;
+		b1[i] = coefficients.b1;
+		b2[i] = coefficients.b2;
+		a1[i] = coefficients.a1;
+		a2[i] = coefficients.a2;
 	}
-	case Slope_36:
+};
+
+// Every parametric band has its own section, but only the active ones are processed,
+// in a loop over their packed indices. Each section keeps its state while it's bypassed
+// and starts from silence when it comes back, like the stages of CutFilterOf.
+template<typename SampleType>
+struct ParametricBandsOf
+{
+	using StageType = Filter<SampleType>;
+	using ContextType = juce::dsp::ProcessContextReplacing<SampleType>;
+
+	static constexpr size_t numLanes = getNumLanes<SampleType>();
+
+	void prepare(const juce::dsp::ProcessSpec& spec)
 	{
-		update<2>(chain, coefficients);
+		for (auto& stage : stages)
+			stage.prepare(spec);
 	}
-	case Slope_24:
+
+	void reset()
 	{
-		update<1>(chain, coefficients);
+		for (auto& stage : stages)
+			stage.reset();
 	}
-	case Slope_12:
+
+	void process(const ContextType& context)
 	{
-		update<0>(chain, coefficients);
+		if (context.isBypassed)
+			return;
+
+		for (int i = 0; i < numActive; ++i)
+			stages[(size_t)activeBands[(size_t)i]].process(context);
 	}
+
+	void setCoefficients(const PackedBandCoefficients& coefficients)
+	{
+		int newActiveMask = 0;
+
+		for (int i = 0; i < coefficients.numActive; ++i)
+		{
+			const auto band = coefficients.bandIndex[(size_t)i];
+			const auto bandMask = 1 << band;
+
+			if ((activeMask & bandMask) == 0)
+				stages[(size_t)band].reset();
+
+			stages[(size_t)band].setCoefficients(coefficients.get(i));
+			activeBands[(size_t)i] = band;
+			newActiveMask |= bandMask;
+		}
+
+		numActive = coefficients.numActive;
+		activeMask = newActiveMask;
+		laneActiveMasks.fill(newActiveMask);
 	}
+
+	// For chains whose lanes follow different settings. Runs every band that's active in any
+	// lane, the lanes without it pass it through unchanged. Bands a lane didn't use until now
+	// start from silence in that lane.
+	void setLaneCoefficients(const std::array<const PackedBandCoefficients*, numLanes>& laneCoefficients)
+	{
+		std::array<int, numLanes> newLaneMasks{};
+		int newActiveMask = 0;
+
+		for (size_t lane = 0; lane < numLanes; ++lane)
+		{
+			const auto& packed = *laneCoefficients[lane];
+
+			for (int i = 0; i < packed.numActive; ++i)
+				newLaneMasks[lane] |= 1 << packed.bandIndex[(size_t)i];
+
+			newActiveMask |= newLaneMasks[lane];
+		}
+
+		numActive = 0;
+
+		for (int band = 0; band < maxParametricBands; ++band)
+		{
+			const auto bandMask = 1 << band;
+
+			if ((newActiveMask & bandMask) == 0)
+				continue;
+
+			auto& stage = stages[(size_t)band];
+
+			for (size_t lane = 0; lane < numLanes; ++lane)
+			{
+				if ((newLaneMasks[lane] & bandMask) == 0)
+					stage.setCoefficients(lane, BiquadCoefficients{});
+				else if ((laneActiveMasks[lane] & bandMask) == 0)
+					stage.reset(lane);
+			}
+
+			activeBands[(size_t)numActive++] = band;
+		}
+
+		for (size_t lane = 0; lane < numLanes; ++lane)
+		{
+			const auto& packed = *laneCoefficients[lane];
+
+			for (int i = 0; i < packed.numActive; ++i)
+				stages[(size_t)packed.bandIndex[(size_t)i]].setCoefficients(lane, packed.get(i));
+		}
+
+		activeMask = newActiveMask;
+		laneActiveMasks = newLaneMasks;
+	}
+
+	int getNumActiveBands() const { return numActive; }
+
+private:
+	std::array<StageType, maxParametricBands> stages;
+	std::array<int, maxParametricBands> activeBands{};
+	int numActive = 0, activeMask = 0;
+
+	// The bands each lane actually filters with, only differs between lanes after setLaneCoefficients()
+	std::array<int, numLanes> laneActiveMasks{};
+};
+
+template<typename SampleType>
+using ChainOf = juce::dsp::ProcessorChain<CutFilterOf<SampleType>, ParametricBandsOf<SampleType>, CutFilterOf<SampleType>>;
+
+using CutFilter = CutFilterOf<float>;
+
+using MonoChain = ChainOf<float>;
+
+// Channels are interleaved into the lanes of one register and run through a single chain.
+// Usually every lane shares the same coefficients, see updateChainLanes() for the exception.
+using SIMDSample = juce::dsp::SIMDRegister<float>;
+
+using SIMDChain = ChainOf<SIMDSample>;
+
+enum ChainPositions
+{
+	LowCut,
+	Bands,
+	HighCut
+};
+
+// Reference designs from juce::dsp, which allocate. The chain uses the closed-form ones below.
+using Coefficients = juce::dsp::IIR::Coefficients<float>::Ptr;
+
+Coefficients makePeakFilter(const BandSettings& bandSettings, double sampleRate);
+
+template <typename CutFilterType, typename CoefficientType>
+void updateCutFilter(CutFilterType& cutFilter,
+	const CoefficientType& coefficients,
+	const Slope& slope)
+{
+	const auto numStages = getNumCutStages(slope);
+
+	cutFilter.setNumStages(numStages);
+
+	for (int i = 0; i < numStages; ++i)
+		cutFilter.getStage(i).setCoefficients(coefficients[(size_t)i]);
 }
 
 inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
@@ -243,10 +630,351 @@ inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleR
 		2 * (chainSettings.highCutSlope + 1));
 }
 
+//==============================================================================
+// Closed-form second order designs, matching juce::dsp::IIR::Coefficients but without allocating.
+// These are cheap enough to be called on the audio thread every few samples.
+BiquadCoefficients makePeakBiquad(double sampleRate, double frequency, double quality, double gainFactor);
+BiquadCoefficients makeLowPassBiquad(double sampleRate, double frequency, double quality);
+BiquadCoefficients makeHighPassBiquad(double sampleRate, double frequency, double quality);
+BiquadCoefficients makeLowShelfBiquad(double sampleRate, double frequency, double quality, double gainFactor);
+BiquadCoefficients makeHighShelfBiquad(double sampleRate, double frequency, double quality, double gainFactor);
+BiquadCoefficients makeNotchBiquad(double sampleRate, double frequency, double quality);
+BiquadCoefficients makeBandPassBiquad(double sampleRate, double frequency, double quality);
+BiquadCoefficients makeTiltBiquad(double sampleRate, double frequency, double quality, double gainFactor);
+
+// The design for the band's type
+BiquadCoefficients makeBandBiquad(const BandSettings& bandSettings, double sampleRate);
+
+// Quality of one second order section of a Butterworth cascade with 'numStages' sections
+double getButterworthQuality(int stage, int numStages);
+
+// One bit per cut filter and per parametric band, see getParametricBandMask()
+enum ChainBands
+{
+	LowCutBand = 1 << 0,
+	HighCutBand = 1 << 1,
+	AllParametricBands = ((1 << maxParametricBands) - 1) << 2,
+	AllBands = LowCutBand | HighCutBand | AllParametricBands
+};
+
+inline int getParametricBandMask(int band) { return 1 << (band + 2); }
+
+// Everything the audio thread needs to update a MonoChain, along with the settings it was designed from
+struct ChainCoefficients
+{
+	static constexpr int maxCutStages = CutFilter::maxStages;
+
+	ChainSettings settings;
+
+	std::array<BiquadCoefficients, maxCutStages> lowCut;
+	PackedBandCoefficients bands;
+	std::array<BiquadCoefficients, maxCutStages> highCut;
+};
+
+// These only copy precomputed values, so they're safe to call on the audio thread
+template<typename ChainType>
+void updateParametricBands(ChainType& chain, const ChainCoefficients& chainCoefficients)
+{
+	chain.template get<ChainPositions::Bands>().setCoefficients(chainCoefficients.bands);
+}
+
+template<typename ChainType>
+void updateLowCutFilters(ChainType& chain, const ChainCoefficients& chainCoefficients)
+{
+	const auto& chainSettings = chainCoefficients.settings;
+
+	chain.template setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+	updateCutFilter(chain.template get<ChainPositions::LowCut>(), chainCoefficients.lowCut, chainSettings.lowCutSlope);
+}
+
+template<typename ChainType>
+void updateHighCutFilters(ChainType& chain, const ChainCoefficients& chainCoefficients)
+{
+	const auto& chainSettings = chainCoefficients.settings;
+
+	chain.template setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+	updateCutFilter(chain.template get<ChainPositions::HighCut>(), chainCoefficients.highCut, chainSettings.highCutSlope);
+}
+
+template<typename ChainType>
+void updateChainFilters(ChainType& chain, const ChainCoefficients& chainCoefficients)
+{
+	updateLowCutFilters(chain, chainCoefficients);
+	updateParametricBands(chain, chainCoefficients);
+	updateHighCutFilters(chain, chainCoefficients);
+}
+
+// Per lane version of updateChainFilters(), for chains whose lanes follow different settings,
+// e.g. mid and side of Mid/Side mode in lanes 0 and 1 of a single pass
+template<typename ChainType, size_t NumLanes>
+void updateChainLanes(ChainType& chain, const std::array<const ChainCoefficients*, NumLanes>& lanes)
+{
+	using StageCoefficients = std::array<BiquadCoefficients, ChainCoefficients::maxCutStages>;
+
+	auto updateCutFilter = [&lanes](auto& cutFilter, bool ChainSettings::* bypassed, Slope ChainSettings::* slope, StageCoefficients ChainCoefficients::* stages)
+		{
+			std::array<int, NumLanes> laneNumStages;
+			std::array<const BiquadCoefficients*, NumLanes> laneCoefficients;
+
+			for (size_t lane = 0; lane < NumLanes; ++lane)
+			{
+				const auto& chainCoefficients = *lanes[lane];
+
+				laneNumStages[lane] = chainCoefficients.settings.*bypassed ? 0 : getNumCutStages(chainCoefficients.settings.*slope);
+				laneCoefficients[lane] = (chainCoefficients.*stages).data();
+			}
+
+			// Bypassed as a whole only if no lane uses it
+			return !cutFilter.setLaneStages(laneNumStages, laneCoefficients);
+		};
+
+	chain.template setBypassed<ChainPositions::LowCut>(updateCutFilter(chain.template get<ChainPositions::LowCut>(),
+		&ChainSettings::lowCutBypassed, &ChainSettings::lowCutSlope, &ChainCoefficients::lowCut));
+
+	chain.template setBypassed<ChainPositions::HighCut>(updateCutFilter(chain.template get<ChainPositions::HighCut>(),
+		&ChainSettings::highCutBypassed, &ChainSettings::highCutSlope, &ChainCoefficients::highCut));
+
+	std::array<const PackedBandCoefficients*, NumLanes> laneBands;
+
+	for (size_t lane = 0; lane < NumLanes; ++lane)
+		laneBands[lane] = &lanes[lane]->bands;
+
+	chain.template get<ChainPositions::Bands>().setLaneCoefficients(laneBands);
+}
+
+// Redesigns the sections of 'destination' flagged in 'bands' and repacks the active parametric bands.
+// Active bands that aren't flagged keep the coefficients they had in 'destination'.
+void designChainCoefficients(ChainCoefficients& destination,
+	const ChainSettings& chainSettings,
+	double sampleRate,
+	int bands);
+
+// Combined magnitude response of every active section, as the chain would produce it
+double getChainMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency, double sampleRate);
+
+// Same as getChainMagnitudeForFrequency, in dB, for a whole set of frequencies at once.
+// With real coefficients |H|^2 of a section is a ratio of two quadratics in cos w, so cos w is
+// computed once per frequency in prepare() and every section then costs two polynomials per
+// frequency, evaluated for several frequencies per SIMD register.
+struct ChainMagnitudeEvaluator
+{
+	using Register = juce::dsp::SIMDRegister<double>;
+
+	// Allocates, so only call it when the frequencies or the sample rate change
+	void prepare(const double* frequencies, int newNumFrequencies, double sampleRate);
+
+	// Writes getNumFrequencies() values, floored at -100 dB like juce::Decibels
+	void process(const ChainCoefficients& chainCoefficients, double* decibels);
+
+	int getNumFrequencies() const { return numFrequencies; }
+
+private:
+	void applySection(const BiquadCoefficients& coefficients);
+
+	int numFrequencies = 0;
+
+	// Padded to whole registers
+	std::vector<Register> cosines, numerators, denominators;
+};
+
+//==============================================================================
+// Parameter smoothing for one set of chain settings. While a parameter moves, the bands it
+// belongs to get redesigned on the audio thread every 'sub block' samples.
+struct ChainSmoother
+{
+	void reset(double sampleRate, double rampLengthSeconds);
+
+	void setTargets(const ChainSettings& chainSettings, bool jumpToTargets);
+	const ChainSettings& getTargets() const { return targetSettings; }
+
+	// Bands with a parameter that hasn't reached its target yet
+	int getSmoothingBands() const;
+
+	// Advances the ramps by numSamples and redesigns the moving bands of getCoefficients()
+	void update(int numSamples, double sampleRate);
+
+	ChainCoefficients& getCoefficients() { return coefficients; }
+
+private:
+	using MultiplicativeValue = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+
+	MultiplicativeValue lowCutFreq, highCutFreq;
+
+	std::array<MultiplicativeValue, maxParametricBands> bandFreqs, bandQualities;
+	std::array<juce::SmoothedValue<float>, maxParametricBands> bandGains;
+
+	ChainSettings targetSettings;
+	ChainCoefficients coefficients;
+};
+
+//==============================================================================
+// Wait-free handoff of the most recent value from one writer thread to one reader thread.
+// The writer fills the back slot and swaps it with the middle one, the reader swaps
+// the middle slot with the front one whenever something new has been published.
+template<typename T>
+struct TripleBuffer
+{
+	T& getWriteBuffer() { return buffers[backIndex]; }
+
+	void publish()
+	{
+		auto previous = middle.exchange(backIndex | newDataFlag, std::memory_order_acq_rel);
+		backIndex = previous & indexMask;
+	}
+
+	// Returns true if a new value was published since the last call
+	bool pull()
+	{
+		if ((middle.load(std::memory_order_relaxed) & newDataFlag) == 0)
+			return false;
+
+		auto previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+		frontIndex = previous & indexMask;
+		return true;
+	}
+
+	// Like pull(), but the value read until now is first swapped into 'previous', so the reader can
+	// keep using it after handing the slot back. The writer overwrites what's left in that slot
+	// before it publishes it again.
+	bool pullKeepingPrevious(T& previous)
+	{
+		if ((middle.load(std::memory_order_relaxed) & newDataFlag) == 0)
+			return false;
+
+		using std::swap;
+		swap(buffers[frontIndex], previous);
+
+		return pull();
+	}
+
+	const T& getReadBuffer() const { return buffers[frontIndex]; }
+
+	// Only safe while neither side is running
+	void reset()
+	{
+		backIndex = 0;
+		frontIndex = 1;
+		middle.store(2);
+	}
+
+	// Only safe while neither side is running, e.g. to preallocate every slot
+	template<typename Function>
+	void forEachBuffer(Function&& function)
+	{
+		for (auto& buffer : buffers)
+			function(buffer);
+	}
+
+private:
+	static constexpr int indexMask = 3;
+	static constexpr int newDataFlag = 4;
+
+	std::array<T, 3> buffers;
+	int backIndex = 0, frontIndex = 1;
+	std::atomic<int> middle{ 2 };
+};
+
+//==============================================================================
+struct CoefficientDesigner;
+
+// Hosts automate parameters on the audio thread, where waking a thread would mean taking a lock.
+// Changes made there are only flagged, and this single message thread timer wakes the designers
+// of every plugin instance in the process that have something to design.
+struct DesignerWakeTimer : private juce::Timer
+{
+	DesignerWakeTimer();
+	~DesignerWakeTimer() override;
+
+	void add(CoefficientDesigner& designer);
+	void remove(CoefficientDesigner& designer);
+
+private:
+	// The most a change made on the audio thread waits before its redesign starts
+	static constexpr int intervalMs = 10;
+
+	void timerCallback() override;
+
+	juce::CriticalSection lock;
+	juce::Array<CoefficientDesigner*> designers;
+};
+
+//==============================================================================
+// Background thread that redesigns the filters whenever a parameter changes and
+// hands complete ChainCoefficients sets over to the audio thread. In linear phase
+// mode it also turns every new set into an FIR kernel.
+// Each designer follows the parameter set with its own prefix, see getChainSettings().
+struct CoefficientDesigner : juce::Thread,
+	juce::AudioProcessorParameter::Listener
+{
+	CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterPrefix = {});
+	~CoefficientDesigner() override;
+
+	// Stops the thread, synchronously designs every band and restarts it.
+	// Returns the initial set so the caller can apply it before processing starts.
+	ChainCoefficients prepare(double sampleRate);
+	void release();
+
+	// Never blocks on the audio thread. On the message thread the designer is woken straight
+	// away, anywhere else DesignerWakeTimer wakes it.
+	void markDirty(int bands);
+
+	// Message thread: wakes the designer thread if any bands are waiting for it
+	void wakeIfDirty();
+
+	// Audio thread: returns true if a new set is available through getLatest()
+	bool pull() { return coefficientBuffer.pull(); }
+	const ChainCoefficients& getLatest() const { return coefficientBuffer.getReadBuffer(); }
+
+	// Same for linear phase kernels, which start out as a pure delay until the mode is enabled.
+	// The kernel in use until now is swapped into 'previous', for crossfading out of it.
+	bool pullKernel(LinearPhaseKernel& previous) { return kernelBuffer.pullKeepingPrevious(previous); }
+	const LinearPhaseKernel& getLatestKernel() const { return kernelBuffer.getReadBuffer(); }
+
+	// Audio thread: true once the latest kernel was designed after the last time "Linear Phase"
+	// changed. Until then it may be a delay, or a kernel for settings from long ago.
+	bool isKernelUpToDate() const { return getLatestKernel().linearPhaseSwitch == linearPhaseSwitches.load(std::memory_order_acquire); }
+
+	void parameterValueChanged(int parameterIndex, float newValue) override;
+	void parameterGestureChanged(int, bool) override {}
+	void run() override;
+
+private:
+	void publishKernel(int linearPhaseSwitch);
+
+	juce::AudioProcessorValueTreeState& apvts;
+	const juce::String parameterPrefix;
+	const ChainParameters parameters;
+	std::atomic<float>* linearPhaseParameter = nullptr;
+
+	// Counts changes of "Linear Phase", both ways. The parameter's value is visible to the audio
+	// thread before the callback runs, so counting only switching on would leave a window in which
+	// a kernel from the previous time linear phase was on looks up to date.
+	int linearPhaseParameterIndex = -1;
+	std::atomic<int> linearPhaseSwitches{ 0 };
+
+	// The sections each parameter affects, by parameter index. Built once in the constructor from
+	// the IDs of this designer's set, so the callbacks, which hosts make on the audio thread, are a
+	// single lookup. Parameters of the other set and the rest stay 0.
+	std::vector<int> bandMaskForParameter;
+
+	// Only touched by the designer thread while it's running
+	ChainCoefficients designed;
+	double sampleRate = 44100.0;
+
+	std::atomic<int> dirtyBands{ 0 };
+	TripleBuffer<ChainCoefficients> coefficientBuffer;
+
+	LinearPhaseDesigner kernelDesigner;
+	TripleBuffer<LinearPhaseKernel> kernelBuffer;
+
+	juce::SharedResourcePointer<DesignerWakeTimer> wakeTimer;
+};
+
 //==============================================================================
 /**
 */
-class EqualizerAudioProcessor  : public juce::AudioProcessor
+class EqualizerAudioProcessor  : public juce::AudioProcessor,
+    private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -291,19 +1019,114 @@ public:
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr,
         "Parameters", createParameterLayout() };
 
+    // Analyzer display settings chosen in the editor. Saved with the state next to
+    // the parameters, but not parameters themselves, so hosts can't automate them.
+    juce::ValueTree analyzerSettings{ "AnalyzerSettings" };
+
 	using BlockType = juce::AudioBuffer<float>;
-	SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left };
-	SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right };
+
+	// The analyzer reads in its own hop size, the taps only have to bridge the time between
+	// two GUI updates. This leaves room for a stalled message thread at up to 192 kHz.
+	static constexpr int analyzerTapCapacity = 1 << 17;
+
+	SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left, analyzerTapCapacity };
+	SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right, analyzerTapCapacity };
+
+    // Any discrete or ambisonic layout up to this many channels is accepted
+    static constexpr int maxNumChannels = 64;
+
+    // The "Processing Mode" parameter, or Stereo for layouts other than stereo
+    ProcessingMode getProcessingMode(int numChannels) const;
 
 private:
-    MonoChain leftChain, rightChain;
+    // One chain per group of SIMDSample::size() channels, so the cost per channel stays
+    // the same however many channels there are
+    juce::OwnedArray<SIMDChain> channelGroupChains;
+
+    // The channels of one group interleaved into the lanes of one SIMDSample per sample.
+    // Shared by all groups, which are processed one after the other.
+    juce::HeapBlock<char> interleavedBlockData;
+    juce::dsp::AudioBlock<SIMDSample> interleavedBlock;
+
+    void processChannelGroup(SIMDChain& chain, const juce::dsp::AudioBlock<float>& block);
+
+    // Updates every channel group's chain with the main settings
+    void updateFilters(const ChainCoefficients& chainCoefficients);
+
+    // The "Side ..." settings, only used in Mid/Side mode
+    void updateSideFilters(const ChainCoefficients& chainCoefficients);
+
+    void processChains(const juce::dsp::AudioBlock<float>& block);
+
+    CoefficientDesigner coefficientDesigner{ apvts };
+
+    // Stereo processing modes. In the mid/side modes the buffer is encoded once before
+    // and decoded once after the filters. Channels a mode doesn't filter are skipped entirely.
+    enum class ChannelRole
+    {
+        main,       // filtered with the main settings
+        side,       // filtered with the "Side ..." settings
+        bypassed
+    };
+
+    std::atomic<float>* processingModeParameter = nullptr;
+    ProcessingMode activeProcessingMode = Stereo;
+
+    ChannelRole getChannelRole(int channel) const;
+
+    // Mid/Side mode runs mid in lane 0 and side in lane 1 of a single pass, each lane with its
+    // own coefficients. Side has its own designer for the "Side ..." parameters.
+    std::unique_ptr<SIMDChain> midSideChain;
+    CoefficientDesigner sideCoefficientDesigner{ apvts, sideParameterPrefix };
+
+    // The sets last applied, which stay valid until the next ones are applied.
+    // The other lanes of the Mid/Side chain carry no channel and just follow mid.
+    const ChainCoefficients* mainCoefficients = nullptr;
+    const ChainCoefficients* sideCoefficients = nullptr;
+
+    void updateMidSideChain();
+
+    // Parameter smoothing. When enabled, the smoothed bands get redesigned on the audio
+    // thread every 'sub block' samples, independently of the host's buffer size.
+    static constexpr double smoothingTimeSeconds = 0.05;
+
+    ChainSmoother smoother, sideSmoother;
+
+    std::atomic<float>* smoothingParameter = nullptr;
+
+    int getSmoothingSubBlockSize() const;
+
+    // Picks up a new set from 'designer' and applies it through 'updateChains'
+    template<typename UpdateFunction>
+    void pullCoefficients(CoefficientDesigner& designer, ChainSmoother& chainSmoother, int subBlockSize, UpdateFunction&& updateChains);
+
+    // Linear phase mode, one convolver per channel sharing the kernel and FFT.
+    // Switching modes changes the latency, so the IIR chains keep their coefficients up to date meanwhile.
+    juce::OwnedArray<PartitionedConvolver> convolvers;
+    std::unique_ptr<juce::dsp::FFT> convolutionFFT;
+
+    std::atomic<float>* linearPhaseParameter = nullptr;
+    bool linearPhaseActive = false;
+
+    // Set by processBlock when it switches modes, and reported to the host on the message thread,
+    // so the host only compensates for the convolution's latency while it actually runs
+    std::atomic<int> pendingLatencySamples{ 0 };
+    void handleAsyncUpdate() override;
+
+    // Keeps channels the processing mode doesn't filter aligned with the convolved ones
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> linearPhaseDelay;
+
+    bool isLinearPhaseEnabled() const { return linearPhaseParameter->load() > 0.5f; }
+    void processLinearPhase(juce::AudioBuffer<float>& buffer);
+
+    // Picks up new kernels, unless a convolver still fades out of the previous one
+    void pullLinearPhaseKernels();
 
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    // Pulls, and returns true once both kernels were designed after the last "Linear Phase" change
+    bool areLinearPhaseKernelsReady();
 
-    void updateFilters();
+    // The kernels the convolvers fade out of after a change, see PartitionedConvolver::crossfadeFrom()
+    LinearPhaseKernel previousKernel, previousSideKernel;
 
 	juce::dsp::Oscillator<float> osc;
     //==============================================================================